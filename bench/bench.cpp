@@ -0,0 +1,471 @@
+#include "attacks.hpp"
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+#include "search.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Args {
+  int samples = 15;
+  double sample_ms = 20.0;
+  double threshold = 0.10; // Relative slowdown reported as a regression
+  std::string json_path = "";
+  std::string baseline_path = "";
+  std::string filter = "";
+  int smp_threads = 0;   // Run the Lazy SMP scaling report up to this many threads instead
+  bool features = false; // Run the selective search report instead
+  int search_depth = 8;
+};
+
+struct BenchResult {
+  std::string name;
+  double ns_per_op = 0.0;
+  double ops_per_second = 0.0;
+  double min_ns_per_op = 0.0;
+  double max_ns_per_op = 0.0;
+};
+
+const char *BENCH_FENS[] = {
+    INITIAL_POSITION_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+struct Tactic {
+  const char *fen;
+  const char *best_move; // Coordinate notation
+};
+
+// Win At Chess 1-10
+const Tactic TACTICS[] = {
+    {"2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1", "g3g6"},
+    {"8/7p/5k2/5p2/p1p2P2/Pr1pPK2/1P1R3P/8 b - - 0 1", "b3b2"},
+    {"5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1", "e3g3"},
+    {"r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1", "h6h7"},
+    {"5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1", "c6c4"},
+    {"7k/p7/1R5K/6r1/6p1/6P1/8/8 w - - 0 1", "b6b7"},
+    {"rnbqkb1r/pppp1ppp/8/4P3/6n1/7P/PPPNPPP1/R1BQKBNR b KQkq - 0 1", "g4e3"},
+    {"r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1", "e7f7"},
+    {"3q1rk1/p4pp1/2pb3p/3p4/6Pr/1PNQ4/P1PB1PP1/4RRK1 b - - 0 1", "d6h2"},
+    {"2br2k1/2q3rn/p2NppQ1/2p1P3/Pp5R/4P3/1P3PPP/3R2K1 w - - 0 1", "h4h7"},
+};
+
+/**
+ * @brief Keep the compiler from discarding a computed value.
+ */
+template<typename T>
+void keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+bool parse_args(int argc, char *argv[], Args &args);
+BenchResult measure(const std::string &name, const Args &args, const std::function<int()> &batch);
+std::map<std::string, double> load_baseline(const std::string &path);
+void write_json(const std::string &path, const std::vector<BenchResult> &results);
+void report_smp_scaling(const Args &args);
+void report_features(const Args &args);
+
+int main(int argc, char *argv[]) {
+  Args args;
+  if (!parse_args(argc, argv, args)) {
+    fprintf(
+        stderr,
+        "Usage: %s [--samples N] [--sample-ms MS] [--filter NAME] [--json FILE]\n"
+        "          [--baseline FILE] [--threshold PCT]\n"
+        "       %s --smp THREADS [--depth N]\n"
+        "       %s --features [--depth N]\n",
+        argv[0],
+        argv[0],
+        argv[0]
+    );
+    return 1;
+  }
+
+  if (args.smp_threads > 0) {
+    report_smp_scaling(args);
+    return 0;
+  }
+  if (args.features) {
+    report_features(args);
+    return 0;
+  }
+
+  const MoveGenerator generator;
+  std::vector<Position> positions;
+  std::vector<MoveList> legal_moves;
+  for (const char *fen : BENCH_FENS) {
+    positions.emplace_back(fen);
+    legal_moves.push_back(generator.generate_legal_moves(positions.back()));
+  }
+
+  // Fixed pseudo-random occupancies shared by the attack lookups
+  std::vector<uint64_t> occupancies;
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for (int i = 0; i < 256; i++) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    occupancies.push_back((state * 2685821657736338717ULL) & (state >> 7));
+  }
+
+  std::vector<std::pair<std::string, std::function<int()>>> benches = {
+      {"generate_pseudo_legal_moves",
+       [&]() {
+         for (const Position &position : positions) {
+           keep(generator.generate_pseudo_legal_moves(position).count);
+         }
+         return static_cast<int>(positions.size());
+       }},
+      {"generate_legal_moves",
+       [&]() {
+         for (const Position &position : positions) {
+           keep(generator.generate_legal_moves(position).count);
+         }
+         return static_cast<int>(positions.size());
+       }},
+      {"make_undo_move",
+       [&]() {
+         int ops = 0;
+         for (size_t i = 0; i < positions.size(); i++) {
+           for (const Move &move : legal_moves[i]) {
+             positions[i].make_move(move);
+             positions[i].undo_move();
+           }
+           keep(positions[i].key);
+           ops += legal_moves[i].count;
+         }
+         return ops;
+       }},
+      {"rook_attacks",
+       [&]() {
+         uint64_t sink = 0;
+         for (uint64_t occupancy : occupancies) {
+           for (int square = 0; square < 64; square++) {
+             sink ^= get_rook_attacks(square, occupancy);
+           }
+         }
+         keep(sink);
+         return static_cast<int>(occupancies.size() * 64);
+       }},
+      {"bishop_attacks",
+       [&]() {
+         uint64_t sink = 0;
+         for (uint64_t occupancy : occupancies) {
+           for (int square = 0; square < 64; square++) {
+             sink ^= get_bishop_attacks(square, occupancy);
+           }
+         }
+         keep(sink);
+         return static_cast<int>(occupancies.size() * 64);
+       }},
+      {"set_fen",
+       [&]() {
+         Position position(INITIAL_POSITION_FEN);
+         for (const char *fen : BENCH_FENS) {
+           position.set_fen(fen);
+           keep(position.key);
+         }
+         return static_cast<int>(std::size(BENCH_FENS));
+       }},
+      {"get_fen",
+       [&]() {
+         for (const Position &position : positions) {
+           keep(position.get_fen().size());
+         }
+         return static_cast<int>(positions.size());
+       }},
+      {"is_in_check",
+       [&]() {
+         for (const Position &position : positions) {
+           keep(generator.is_in_check(position, position.to_move));
+         }
+         return static_cast<int>(positions.size());
+       }},
+      {"see",
+       [&]() {
+         int ops = 0;
+         for (size_t i = 0; i < positions.size(); i++) {
+           for (const Move &move : legal_moves[i]) {
+             if (!move.is_capture()) continue;
+             keep(generator.see(positions[i], move));
+             ops++;
+           }
+         }
+         return ops;
+       }},
+  };
+
+  std::vector<BenchResult> results;
+  for (const auto &[name, batch] : benches) {
+    if (!args.filter.empty() && name.find(args.filter) == std::string::npos) continue;
+    results.push_back(measure(name, args, batch));
+  }
+
+  std::map<std::string, double> baseline;
+  if (!args.baseline_path.empty()) baseline = load_baseline(args.baseline_path);
+
+  int regressions = 0;
+  printf("%-28s %12s %14s %10s\n", "benchmark", "ns/op", "ops/s", "vs base");
+  for (const BenchResult &result : results) {
+    printf("%-28s %12.2f %14.0f", result.name.c_str(), result.ns_per_op, result.ops_per_second);
+
+    auto it = baseline.find(result.name);
+    if (it != baseline.end() && it->second > 0) {
+      const double change = result.ns_per_op / it->second - 1.0;
+      const bool regressed = change > args.threshold;
+      regressions += regressed;
+      printf(" %+9.1f%%%s", change * 100.0, regressed ? "  REGRESSION" : "");
+    }
+    printf("\n");
+  }
+
+  if (!args.json_path.empty()) write_json(args.json_path, results);
+
+  return regressions > 0 ? 2 : 0;
+}
+
+bool parse_args(int argc, char *argv[], Args &args) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--samples" && has_value) {
+      args.samples = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--sample-ms" && has_value) {
+      args.sample_ms = std::atof(argv[++i]);
+    } else if (arg == "--threshold" && has_value) {
+      args.threshold = std::atof(argv[++i]) / 100.0;
+    } else if (arg == "--json" && has_value) {
+      args.json_path = argv[++i];
+    } else if (arg == "--baseline" && has_value) {
+      args.baseline_path = argv[++i];
+    } else if (arg == "--filter" && has_value) {
+      args.filter = argv[++i];
+    } else if (arg == "--smp" && has_value) {
+      args.smp_threads = std::atoi(argv[++i]);
+    } else if (arg == "--features") {
+      args.features = true;
+    } else if (arg == "--depth" && has_value) {
+      args.search_depth = std::atoi(argv[++i]);
+    } else {
+      return false;
+    }
+  }
+
+  return args.sample_ms > 0 && args.smp_threads >= 0 && args.search_depth > 0;
+}
+
+/**
+ * @brief Calibrate a repeat count so one sample takes about sample_ms, warm up for one sample,
+ * then report the median of the timed samples.
+ */
+BenchResult measure(const std::string &name, const Args &args, const std::function<int()> &batch) {
+  using Clock = std::chrono::steady_clock;
+
+  auto run_sample = [&](int repeats) {
+    auto start = Clock::now();
+    long long ops = 0;
+    for (int i = 0; i < repeats; i++) {
+      ops += batch();
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return std::make_pair(elapsed.count(), ops);
+  };
+
+  int repeats = 1;
+  while (true) {
+    auto [elapsed_ns, ops] = run_sample(repeats);
+    if (elapsed_ns >= args.sample_ms * 1e6 || repeats >= (1 << 24)) break;
+    repeats *= 2;
+  }
+  run_sample(repeats);
+
+  std::vector<double> ns_per_op;
+  for (int sample = 0; sample < args.samples; sample++) {
+    auto [elapsed_ns, ops] = run_sample(repeats);
+    ns_per_op.push_back(elapsed_ns / ops);
+  }
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+
+  BenchResult result;
+  result.name = name;
+  result.ns_per_op = ns_per_op[ns_per_op.size() / 2];
+  result.ops_per_second = 1e9 / result.ns_per_op;
+  result.min_ns_per_op = ns_per_op.front();
+  result.max_ns_per_op = ns_per_op.back();
+  return result;
+}
+
+/**
+ * @brief Read name -> ns/op pairs from a file previously written with --json.
+ */
+std::map<std::string, double> load_baseline(const std::string &path) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(path);
+  if (!file) {
+    fprintf(stderr, "Could not open baseline %s\n", path.c_str());
+    return baseline;
+  }
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string text = buffer.str();
+
+  const std::string name_key = "\"name\": \"";
+  const std::string ns_key = "\"ns_per_op\": ";
+  size_t position = 0;
+  while ((position = text.find(name_key, position)) != std::string::npos) {
+    position += name_key.size();
+    const size_t name_end = text.find('"', position);
+    const size_t ns_start = text.find(ns_key, name_end);
+    if (name_end == std::string::npos || ns_start == std::string::npos) break;
+
+    const std::string name = text.substr(position, name_end - position);
+    baseline[name] = std::atof(text.c_str() + ns_start + ns_key.size());
+    position = ns_start;
+  }
+
+  return baseline;
+}
+
+void write_json(const std::string &path, const std::vector<BenchResult> &results) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file) {
+    fprintf(stderr, "Could not write %s\n", path.c_str());
+    return;
+  }
+
+  fprintf(file, "{\n  \"benchmarks\": [");
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &result = results[i];
+    fprintf(file, i ? ",\n" : "\n");
+    fprintf(file, "    {\"name\": \"%s\", ", result.name.c_str());
+    fprintf(file, "\"ns_per_op\": %.3f, ", result.ns_per_op);
+    fprintf(file, "\"ops_per_second\": %.0f, ", result.ops_per_second);
+    fprintf(file, "\"min_ns_per_op\": %.3f, ", result.min_ns_per_op);
+    fprintf(file, "\"max_ns_per_op\": %.3f}", result.max_ns_per_op);
+  }
+  fprintf(file, "\n  ]\n}\n");
+  fclose(file);
+}
+
+/**
+ * @brief Time-to-depth of a fixed-depth search over the bench positions for 1, 2, 4, ... threads,
+ * each from an empty table. Speed-up is relative to the single-threaded run.
+ */
+void report_smp_scaling(const Args &args) {
+  printf("%-8s %10s %14s %12s %9s\n", "threads", "seconds", "nodes", "nps", "speed-up");
+
+  double single_thread_seconds = 0.0;
+  for (int threads = 1; threads <= args.smp_threads; threads *= 2) {
+    SearchOptions options;
+    options.threads = threads;
+    options.hash_mb = 64;
+    Search search(options);
+
+    SearchLimits limits;
+    limits.depth = args.search_depth;
+
+    double seconds = 0.0;
+    uint64_t nodes = 0;
+    for (const char *fen : BENCH_FENS) {
+      search.clear();
+      SearchResult result = search.run(Position(fen), limits);
+      seconds += result.seconds;
+      nodes += result.nodes;
+    }
+
+    if (threads == 1) single_thread_seconds = seconds;
+    printf(
+        "%-8d %10.3f %14llu %12.0f %8.2fx\n",
+        threads,
+        seconds,
+        static_cast<unsigned long long>(nodes),
+        nodes / seconds,
+        single_thread_seconds / seconds
+    );
+  }
+}
+
+/**
+ * @brief Time-to-depth over the bench positions and Win At Chess solutions at the same depth, with
+ * every selective technique on, each one switched off in turn, and all of them off.
+ */
+void report_features(const Args &args) {
+  struct Variant {
+    const char *name;
+    bool SearchFeatures::*toggle; // Switched off, nullptr for the all-on and all-off rows
+    bool enabled;
+  };
+  const Variant variants[] = {
+      {"all", nullptr, true},
+      {"-pvs", &SearchFeatures::pvs, true},
+      {"-aspiration", &SearchFeatures::aspiration, true},
+      {"-null_move", &SearchFeatures::null_move, true},
+      {"-lmr", &SearchFeatures::late_move_reductions, true},
+      {"-futility", &SearchFeatures::futility, true},
+      {"-check_ext", &SearchFeatures::check_extensions, true},
+      {"none", nullptr, false},
+  };
+
+  printf("%-12s %10s %14s %8s\n", "features", "seconds", "nodes", "solved");
+
+  for (const Variant &variant : variants) {
+    SearchFeatures features;
+    if (!variant.enabled) features = {false, false, false, false, false, false};
+    if (variant.toggle) features.*variant.toggle = false;
+
+    SearchOptions options;
+    options.hash_mb = 64;
+    options.features = features;
+    Search search(options);
+
+    SearchLimits limits;
+    limits.depth = args.search_depth;
+
+    double seconds = 0.0;
+    uint64_t nodes = 0;
+    for (const char *fen : BENCH_FENS) {
+      search.clear();
+      SearchResult result = search.run(Position(fen), limits);
+      seconds += result.seconds;
+      nodes += result.nodes;
+    }
+
+    int solved = 0;
+    for (const Tactic &tactic : TACTICS) {
+      search.clear();
+      const Position position(tactic.fen);
+      const Move best = search.run(position, limits).best_move;
+      const std::string played = {
+          static_cast<char>('a' + square_file(best.from)),
+          static_cast<char>('1' + square_rank(best.from)),
+          static_cast<char>('a' + square_file(best.to)),
+          static_cast<char>('1' + square_rank(best.to)),
+      };
+      if (played == tactic.best_move) solved++;
+    }
+
+    printf(
+        "%-12s %10.3f %14llu %5d/%zu\n",
+        variant.name,
+        seconds,
+        static_cast<unsigned long long>(nodes),
+        solved,
+        sizeof(TACTICS) / sizeof(TACTICS[0])
+    );
+  }
+}
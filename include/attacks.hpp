@@ -4,6 +4,10 @@
 
 #include <array>
 
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
 constexpr std::array<std::array<uint64_t, 64>, 2> init_pawn_attacks() {
   std::array<std::array<uint64_t, 64>, 2> pawn_attacks{}; // [PieceColor][Square]
   const uint64_t NOT_FILE_A = ~FILE_A;
@@ -70,5 +74,47 @@ constexpr std::array<uint64_t, 64> init_king_attacks() {
   return king_attacks;
 }
 
-uint64_t get_rook_attacks(int square, uint64_t occupancy);
-uint64_t get_bishop_attacks(int square, uint64_t occupancy);
+/**
+ * @brief Slider lookup entry for one square. With USE_PEXT the relevant occupancy bits are
+ * extracted directly with BMI2, otherwise they are hashed with a magic multiplier.
+ */
+struct Magic {
+  uint64_t mask;     // Relevant occupancy, board edges excluded
+  uint64_t magic;    // Unused with USE_PEXT
+  uint64_t *attacks; // Slice of the shared attack table owned by this square
+  unsigned shift;    // 64 - popcount(mask)
+
+  unsigned index(uint64_t occupancy) const {
+#ifdef USE_PEXT
+    return static_cast<unsigned>(_pext_u64(occupancy, mask));
+#else
+    return static_cast<unsigned>(((occupancy & mask) * magic) >> shift);
+#endif
+  }
+};
+
+extern Magic ROOK_MAGICS[64];
+extern Magic BISHOP_MAGICS[64];
+extern uint64_t BETWEEN_BB[64][64];
+extern uint64_t LINE_BB[64][64];
+
+inline uint64_t get_rook_attacks(int square, uint64_t occupancy) {
+  const Magic &entry = ROOK_MAGICS[square];
+  return entry.attacks[entry.index(occupancy)];
+}
+
+inline uint64_t get_bishop_attacks(int square, uint64_t occupancy) {
+  const Magic &entry = BISHOP_MAGICS[square];
+  return entry.attacks[entry.index(occupancy)];
+}
+
+/**
+ * @brief Squares strictly between two aligned squares, empty if they share no rank, file or
+ * diagonal.
+ */
+inline uint64_t between_bb(int from, int to) { return BETWEEN_BB[from][to]; }
+
+/**
+ * @brief Full board-spanning line through two aligned squares, empty if they are not aligned.
+ */
+inline uint64_t line_bb(int from, int to) { return LINE_BB[from][to]; }
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <ncurses.h>
 #include <optional>
+#include <string>
 
 enum class BoardOrientation {
   WHITE,
@@ -45,12 +46,14 @@ private:
       {"Arrow keys / hjkl - Move cursor",
        "Space / Enter - Select piece / Move piece",
        "o - Invert board orientation",
+       "s - Make the engine move now",
        "? - Show help",
        "q - Quit to main menu"}
   };
   Popup promote_popup{{"Choose promotion piece:"}, {"Queen", "Rook", "Bishop", "Knight"}};
 
   void handle_piece_selection();
+  std::string engine_status();
   void printw_board();
   void printw_rank_labels();
   void printw_file_labels();
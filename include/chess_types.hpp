@@ -20,8 +20,14 @@
 #define FILE_G (FILE_A << 6)
 #define FILE_H (FILE_A << 7)
 
+#define LIGHT_SQUARES 0x55AA55AA55AA55AAULL
+#define DARK_SQUARES (~LIGHT_SQUARES)
+
 #define INITIAL_POSITION_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
 #define MAX_POSSIBLE_LEGAL_MOVES 256
+#define MAX_GAME_PLIES 1024 // Moves a game may hold; GameState refuses any beyond
+#define MAX_SEARCH_PLY 128  // Deepest line a search plays out on top of the game
+#define MAX_POSITION_PLIES (MAX_GAME_PLIES + MAX_SEARCH_PLY) // Capacity of Position's undo stack
 
 // clang-format off
 // Little-endian rank-file
@@ -34,6 +40,7 @@ enum Square : uint8_t {
   A3 = 2 * 8, B3, C3, D3, E3, F3, G3, H3,
   A2 = 1 * 8, B2, C2, D2, E2, F2, G2, H2,
   A1 = 0 * 8, B1, C1, D1, E1, F1, G1, H1,
+  NO_SQUARE = 64,
 };
 // clang-format on
 
@@ -120,6 +127,14 @@ struct Move {
   bool operator!=(const Move &other) const { return !(*this == other); }
 };
 
+/**
+ * @brief Pack from, to and promotion piece into 16 bits. Move type flags are not stored, they are
+ * recovered from the board when a hash or killer move is reused.
+ */
+constexpr uint16_t encode_move(const Move &move) {
+  return static_cast<uint16_t>(move.from | move.to << 6 | move.promotion_piece << 12);
+}
+
 constexpr uint64_t square_to_bit(Square square) { return 1ULL << (square); }
 constexpr int square_file(int sq) { return sq % 8; }
 constexpr int square_rank(int sq) { return sq / 8; }
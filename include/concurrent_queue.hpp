@@ -0,0 +1,36 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Unbounded multi-producer, multi-consumer FIFO. Consumers poll with try_pop, so a UI loop
+ * can drain it between frames without ever blocking.
+ */
+template<typename T>
+class ConcurrentQueue {
+public:
+  void push(T value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.push_back(std::move(value));
+  }
+
+  bool try_pop(T &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) return false;
+
+    value = std::move(items.front());
+    items.pop_front();
+    return true;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.clear();
+  }
+
+private:
+  std::mutex mutex;
+  std::deque<T> items;
+};
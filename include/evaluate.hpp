@@ -0,0 +1,16 @@
+#pragma once
+
+#include "pawn_table.hpp"
+#include "position.hpp"
+#include "psqt.hpp"
+
+// [PieceType], for exchanges: the middlegame material, so SEE and the evaluation agree
+static constexpr const int (&PIECE_VALUES)[7] = MATERIAL_MG;
+
+/**
+ * @brief Static evaluation in centipawns from the side to move's point of view. Material and
+ * piece-square totals come from the position's incremental accumulators and are blended between
+ * middlegame and endgame weights by game phase, on top of pawn structure, mobility and
+ * king-safety terms. Pawn structure is cached in pawn_table when one is given.
+ */
+int evaluate(const Position &position, PawnTable *pawn_table = nullptr);
@@ -1,33 +1,156 @@
 #pragma once
 
-#include <cstdio>
-#include <memory>
+#include "chess_types.hpp"
+#include "line_buffer.hpp"
+#include "time_manager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief Owns a file descriptor and closes it on destruction.
+ */
+class FileDescriptor {
+public:
+  explicit FileDescriptor(int fd = -1) : fd(fd) {}
+  ~FileDescriptor() { reset(); }
+  FileDescriptor(const FileDescriptor &) = delete;
+  FileDescriptor &operator=(const FileDescriptor &) = delete;
 
-struct FileDeleter {
-  void operator()(FILE *file) const {
-    if (file) fclose(file);
+  void reset(int new_fd = -1) {
+    if (fd >= 0) close(fd);
+    fd = new_fd;
   }
+  int get() const { return fd; }
+  explicit operator bool() const { return fd >= 0; }
+
+private:
+  int fd;
 };
 
-using FilePtr = std::unique_ptr<FILE, FileDeleter>;
+/**
+ * @brief Round-trip times of one kind of command, from sending it to reading its answer.
+ */
+struct CommandLatency {
+  uint64_t count = 0;
+  double last_ms = 0.0;
+  double total_ms = 0.0;
+  double max_ms = 0.0;
 
+  double average_ms() const { return count ? total_ms / count : 0.0; }
+};
+
+/**
+ * @brief UCI engine in a child process. Both pipes are non-blocking and every wait is a poll()
+ * with a deadline, so a silent, hung or crashed engine can only cost the caller its timeout. Not
+ * thread safe: one thread at a time talks to the engine.
+ */
 class ExtEngine {
 public:
+  /** @brief Start the engine; throws std::runtime_error if it does not answer "uci" in time. */
   ExtEngine(const std::string &command);
   ~ExtEngine();
 
-  void send_command(const std::string &command);
+  /** @brief Write one line; false if the engine is gone or stopped reading. */
+  bool send_command(const std::string &command);
   void set_position(const std::string &fen);
+
+  /**
+   * @brief Send the game as its starting position and the moves played since, space separated
+   * UCI, so the engine keeps the history for repetitions. The initial position goes as "startpos".
+   */
+  void set_position(const std::string &root_fen, const std::string &moves);
+
+  /** @brief "ucinewgame" and the isready handshake it needs; false if the engine stays silent. */
+  bool new_game();
   std::string get_best_move(int depth = 1, int timeMs = 1000);
 
+  /**
+   * @brief Search with both game clocks, leaving the time allocation to the engine. Setting stop,
+   * from any thread, sends "stop" so the engine answers with its best move so far.
+   */
+  std::string get_best_move(
+      const GameClock &clock,
+      PieceColor side,
+      const std::atomic<bool> *stop = nullptr
+  );
+
+  /**
+   * @brief Search the position after the expected reply, set with set_position, while the opponent
+   * thinks. Setting ponderhit sends "ponderhit" and the search goes on as a normal one on the
+   * clock; setting stop ends it early. Returns the best move like get_best_move.
+   */
+  std::string ponder(
+      const GameClock &clock,
+      PieceColor side,
+      const std::atomic<bool> *stop,
+      const std::atomic<bool> *ponderhit
+  );
+
+  /** @brief Reply the engine expected after the last best move, empty if it named none. */
+  const std::string &get_ponder_move() const { return ponder_move; }
+
+  /** @brief Whether the engine announced the UCI "Ponder" option. */
+  bool supports_ponder() const { return can_ponder; }
+  void set_option(const std::string &name, const std::string &value);
+
+  /** @brief Latencies of the answered commands by their first word, e.g. "uci" or "go". */
+  CommandLatency get_latency(const std::string &command_name) const;
+
+  using InfoHandler = std::function<void(std::string_view line)>;
+
+  /**
+   * @brief Receive every "info" line read while waiting for an answer, on the waiting thread. The
+   * view is only valid during the call.
+   */
+  void set_info_handler(InfoHandler handler) { info_handler = std::move(handler); }
+
 private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Flags forwarded to the engine while waiting for "bestmove", each at most once.
+   */
+  struct GoSignals {
+    const std::atomic<bool> *stop = nullptr;
+    const std::atomic<bool> *ponderhit = nullptr;
+    int ponderhit_timeout_ms = 0; // New deadline once the ponderhit is sent
+  };
+
   std::string command;
   pid_t childPid;
-  FilePtr engineIn;
-  FilePtr engineOut;
+  FileDescriptor engineIn;
+  FileDescriptor engineOut;
+  LineBuffer output;
+  bool output_closed = false;
+  bool out_of_sync = false; // An answer timed out and may still arrive
+  std::unordered_map<std::string, CommandLatency> latencies;
+  InfoHandler info_handler;
+  std::string ponder_move;
+  bool can_ponder = false;
 
-  std::string read_line();
-  std::string read_until(const std::string &expected_response, int timeout_ms);
+  std::string request(
+      const std::string &command,
+      const std::string &expected,
+      int timeout_ms,
+      const GoSignals &signals
+  );
+  std::string go(const std::string &go_command, int timeout_ms, const GoSignals &signals);
+  bool read_line(std::string_view &line, Clock::time_point deadline);
+  std::string read_until(
+      const std::string &expected_response,
+      int timeout_ms,
+      const GoSignals &signals
+  );
+  void handle_line(std::string_view line);
+  bool synchronize();
+  void shutdown();
 };
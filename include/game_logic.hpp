@@ -1,11 +1,21 @@
 #pragma once
 
 #include "chess_types.hpp"
+#include "concurrent_queue.hpp"
 #include "ext_engine.hpp"
 #include "move_gen.hpp"
+#include "perft.hpp"
 #include "position.hpp"
+#include "search.hpp"
+#include "thread_pool.hpp"
+#include "time_manager.hpp"
+#include "uci_info.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 
 enum GameMode {
   PLAYER_VS_PLAYER,
@@ -18,26 +28,33 @@ enum GameResult {
   STALEMATE,
   DRAW_INSUFFICIENT_MATERIAL,
   DRAW_FIFTY_MOVE_RULE,
+  DRAW_REPETITION,
   DRAW_OTHER
 };
 
 class GameState {
 public:
-  GameState(const std::string &engine_cmd, const std::string &fen = INITIAL_POSITION_FEN) :
-      pos(fen) {
+  GameState(
+      const std::string &engine_cmd,
+      const std::string &fen = INITIAL_POSITION_FEN,
+      const SearchOptions &search_options = {}
+  ) :
+      search(search_options), pos(fen), root_fen(fen) {
     set_engine(engine_cmd);
   }
   GameState() : pos(INITIAL_POSITION_FEN) {}
+  ~GameState() { cancel_engine_move(); }
 
   void new_game(GameMode mode, PieceColor player_color = ANY);
   void end_game() { ongoing_game = false; }
   bool is_game_ongoing() const { return ongoing_game && get_game_result() == GAME_ONGOING; }
-  bool has_engine_available() const { return has_engine; }
+  bool has_engine_available() const { return true; } // The built-in search is the fallback
+  bool has_external_engine() const { return has_engine; }
   GameMode get_current_mode() const { return current_mode; }
   PieceColor get_player_color() const { return player_color; }
 
   std::string get_fen() const { return pos.get_fen(); }
-  void set_fen(const std::string &fen) { return pos.set_fen(fen); }
+  void set_fen(const std::string &fen);
 
   PieceColor to_move() const { return pos.to_move; }
   Piece get_piece_at(int square) { return pos.get_piece_at(static_cast<Square>(square)); }
@@ -48,8 +65,50 @@ public:
 
   bool make_move(const Move &move);
   void undo_move();
-  uint64_t perft(int depth);
+  uint64_t perft(int depth, const PerftOptions &options = {}) const;
+
+  /** @brief Takes effect from the next new game. */
+  void set_time_control(const TimeControl &control) { time_control = control; }
+  const GameClock &get_clock() const { return clock; }
+
+  /**
+   * @brief Start the engine thinking on its own thread, on the side to move's clock within a
+   * budget from the time manager. The engine works on a copy of the position; moves are refused
+   * until its reply has been played by poll_engine_move.
+   */
+  bool start_engine_move();
+
+  /** @brief Play the engine's reply if it has arrived; call it regularly from the UI loop. */
+  bool poll_engine_move();
+
+  bool is_engine_thinking() const { return engine_thinking; }
+
+  /**
+   * @brief Let an external engine that supports it think on its expected reply during the player's
+   * turn. Playing that reply turns the ponder search into the engine's move ("ponderhit"), any
+   * other move stops it. The engine's Ponder option is only set when a new game starts.
+   */
+  void set_pondering(bool enabled) { pondering_enabled = enabled; }
+  bool is_engine_pondering() const { return engine_pondering; }
+  uint64_t get_ponder_hits() const { return ponder_hits; }
+  uint64_t get_ponder_misses() const { return ponder_misses; }
+
+  /** @brief Share of ponder searches whose expected reply was played, 0 before the first one. */
+  double ponder_hit_rate() const {
+    const uint64_t total = ponder_hits + ponder_misses;
+    return total ? static_cast<double>(ponder_hits) / total : 0.0;
+  }
+
+  /** @brief Latest statistics of an external engine's current search, updated by polling. */
+  const std::optional<UciInfo> &get_engine_info() const { return engine_info; }
+
+  /** @brief Ask the engine to reply now with the best move it has found so far. */
+  void stop_engine() { engine_stop.store(true, std::memory_order_relaxed); }
 
+  /** @brief Stop a thinking or pondering engine and drop its reply, waiting until it is idle. */
+  void cancel_engine_move();
+
+  /** @brief Think and play the reply, blocking until it is made. */
   bool make_engine_move();
 
   GameResult get_game_result() const;
@@ -60,15 +119,54 @@ private:
   bool ongoing_game = false;
   bool has_engine = false;
 
+  TimeControl time_control{};
+  GameClock clock{};
+
+  /**
+   * @brief Reply of the engine thread. Replies of a cancelled search carry an old generation and
+   * are dropped.
+   */
+  struct EngineReply {
+    uint64_t generation = 0;
+    std::optional<Move> move; // Built-in search
+    std::string uci_move;     // External engine
+    std::string ponder_move;  // Reply the external engine expects, if it named one
+  };
+
+  // Owned by the engine thread while engine_thinking or engine_pondering is set
   std::unique_ptr<ExtEngine> engine = nullptr;
+  Search search;
   MoveGenerator generator;
   Position pos;
 
+  // The game as the engine sees it: "position fen <root_fen> moves <uci_moves>"
+  std::string root_fen = INITIAL_POSITION_FEN;
+  std::string uci_moves; // Space separated, played since root_fen
+  bool engine_new_game = true;
+  bool pondering_enabled = true;
+
+  std::unique_ptr<ThreadPool> engine_thread; // Created on the first engine move
+  ConcurrentQueue<EngineReply> engine_replies;
+  ConcurrentQueue<UciInfo> engine_infos;
+  std::optional<UciInfo> engine_info;
+  std::atomic<bool> engine_stop{false};
+  uint64_t engine_generation = 0;
+  bool engine_thinking = false;
+
+  // A ponder search on ponder_move becomes the engine's move when the player makes it
+  bool engine_pondering = false;
+  Move ponder_move{};
+  std::atomic<bool> engine_ponderhit{false};
+  uint64_t ponder_hits = 0;
+  uint64_t ponder_misses = 0;
+
   bool validate_move(const Move &move) const;
   mutable bool legal_cache_valid = false;
   mutable MoveList legal_moves{};
 
   MoveList get_cached_moves();
+  bool make_uci_move(const std::string &uci_move);
+  void start_pondering(const std::string &expected_reply);
   void set_engine(const std::string &engine_cmd) {
     if (engine_cmd.empty()) return;
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+
+/**
+ * @brief Splits the output of a file descriptor into lines. Bytes are read into a fixed ring and
+ * lines are handed out as views, so reading allocates nothing after construction. A line longer
+ * than the ring is cut at the ring's size and the rest of it dropped.
+ */
+class LineBuffer {
+public:
+  static constexpr size_t CAPACITY = 1 << 16;
+
+  LineBuffer();
+
+  /**
+   * @brief Read whatever fd has available without blocking on a non-blocking descriptor.
+   * @return Bytes read, 0 at end of file, -1 with errno set when nothing could be read.
+   */
+  ssize_t fill(int fd);
+
+  /** @brief Append bytes as if they were read; returns how many fitted. */
+  size_t append(const char *bytes, size_t count);
+
+  /**
+   * @brief Take the next complete line without its "\n" or "\r\n". The view stays valid until
+   * the next call to fill, append or next_line.
+   */
+  bool next_line(std::string_view &line);
+
+  size_t size() const { return static_cast<size_t>(tail - head); }
+  void clear();
+
+private:
+  std::unique_ptr<char[]> ring;
+  std::unique_ptr<char[]> wrapped; // Linear copy of a line that crosses the end of the ring
+  uint64_t head = 0;               // Start of the unread bytes, grows without wrapping
+  uint64_t tail = 0;               // End of the unread bytes
+  uint64_t scanned = 0;            // Bytes before this hold no newline
+  bool discarding = false;         // Dropping the rest of an overlong line
+
+  std::string_view take(uint64_t end, uint64_t next_head);
+};
@@ -33,23 +33,68 @@ struct MoveList {
   const Move &operator[](int index) const { return moves[index]; }
 };
 
+/**
+ * @brief Legality constraints of the side to move, computed once per position.
+ * Pseudo-legal generation uses the permissive defaults.
+ */
+struct CheckInfo {
+  Square king_square{};
+  uint64_t checkers = 0;         // Enemy pieces giving check
+  uint64_t pinned = 0;           // Our pieces pinned to our king
+  uint64_t check_mask = ~0ULL;   // Destinations that resolve check for non-king moves
+  uint64_t king_danger = 0;      // Squares attacked by the enemy, seen through our king
+  bool exact_en_passant = false; // Reject en passant captures that expose the king
+};
+
+/**
+ * @brief Which moves a generator call produces. Captures covers every move that changes material:
+ * captures, en passant and all promotions. Quiets is everything else, including castling.
+ */
+enum GenType : uint8_t {
+  GEN_ALL,
+  GEN_CAPTURES,
+  GEN_QUIETS
+};
+
 class MoveGenerator {
 public:
   MoveList generate_pseudo_legal_moves(const Position &position) const;
   MoveList generate_legal_moves(const Position &position) const;
+  void generate_legal_moves(const Position &position, MoveList &move_list) const;
+  void generate_legal_captures(const Position &position, MoveList &move_list) const;
+  void generate_legal_quiets(const Position &position, MoveList &move_list) const;
+  int count_legal_moves(const Position &position) const;
+  bool is_legal(const Position &position, const Move &move) const;
   bool is_in_check(const Position &position, PieceColor color) const;
+  uint64_t get_checkers(const Position &position) const;
+
+  uint64_t attackers_to(const Position &position, Square square, uint64_t occupancy) const;
+  int see(const Position &position, const Move &move) const;
+  uint64_t hanging_pieces(const Position &position, PieceColor color) const;
 
 private:
-  template<PieceColor Us>
-  int generate_pawn_moves(const Position &position, Move *moves) const;
+  template<GenType Gen>
+  void generate_legal(const Position &position, MoveList &move_list) const;
 
-  template<PieceType PieceT>
-  int generate_piece_moves(const Position &position, Move *moves) const;
+  template<PieceColor Us, GenType Gen = GEN_ALL>
+  int generate_pawn_moves(const Position &position, const CheckInfo &info, Move *moves) const;
+
+  template<PieceType PieceT, GenType Gen = GEN_ALL>
+  int generate_piece_moves(const Position &position, const CheckInfo &info, Move *moves) const;
 
   int generate_castling_moves(const Position &position, Move *moves) const;
+  uint64_t castling_destinations(const Position &position) const;
+
+  template<PieceColor Us>
+  int count_pawn_moves(const Position &position, const CheckInfo &info) const;
+
+  template<PieceType PieceT>
+  int count_piece_moves(const Position &position, const CheckInfo &info) const;
 
+  CheckInfo compute_check_info(const Position &position) const;
+  uint64_t compute_king_danger(const Position &position, PieceColor enemy_color) const;
+  bool is_legal_en_passant(const Position &position, Square from, Square to, Square king) const;
   bool is_square_attacked(const Position &position, Square square, PieceColor by_color) const;
-  bool is_legal_move(const Position &position, const Move &move) const;
   Square find_king(const Position &position, PieceColor color) const;
 
   const std::array<std::array<uint64_t, 64>, 2> PAWN_ATTACKS = init_pawn_attacks();
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+
+#include <cstdint>
+
+/**
+ * @brief Yields the legal moves of a position lazily in stages: the hash move, winning captures
+ * and promotions, killer moves, quiet moves by history, then losing captures. The hash move and
+ * killers are validated against the board instead of a generated list, so a cutoff on any of them
+ * saves generating the quiet moves at all. With captures_only, as in quiescence, only the captures
+ * and promotions that do not lose material are returned.
+ */
+class MovePicker {
+public:
+  using History = int[2][64][64]; // [PieceColor][from][to], bonus for quiet moves that cut off
+
+  void reset(
+      const Position &position,
+      const MoveGenerator &generator,
+      uint16_t hash_move,
+      const Move *killers,
+      const History *history,
+      bool captures_only
+  );
+  bool next(Move &move);
+
+private:
+  enum Stage : uint8_t {
+    STAGE_HASH_MOVE,
+    STAGE_GENERATE_CAPTURES,
+    STAGE_WINNING_CAPTURES,
+    STAGE_KILLERS,
+    STAGE_GENERATE_QUIETS,
+    STAGE_QUIETS,
+    STAGE_LOSING_CAPTURES,
+    STAGE_DONE
+  };
+
+  const Position *position = nullptr;
+  const MoveGenerator *generator = nullptr;
+  const History *history = nullptr;
+  Stage stage = STAGE_DONE;
+  bool captures_only = false;
+
+  uint16_t hash_move = 0;
+  uint16_t killers[2]{};
+  int killer_index = 0;
+
+  MoveList captures{};
+  int capture_scores[MAX_POSSIBLE_LEGAL_MOVES]{};
+  int capture_index = 0;
+  int losing_count = 0; // Losing captures are parked at the front of captures
+
+  MoveList quiets{};
+  int quiet_scores[MAX_POSSIBLE_LEGAL_MOVES]{};
+  int quiet_index = 0;
+
+  bool already_tried(const Move &move) const;
+  bool is_losing_capture(const Move &move) const;
+  Move decode(uint16_t code) const;
+};
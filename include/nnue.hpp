@@ -0,0 +1,93 @@
+#pragma once
+
+#include "chess_types.hpp"
+#include "position.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+constexpr int NNUE_INPUTS = 64 * 10 * 64; // HalfKP: [own king square][piece][square], no kings
+constexpr int NNUE_MAX_HIDDEN = 512;      // Widest accumulator the fixed-size stack can hold
+constexpr int NNUE_ACTIVATION_MAX = 255;  // Clipped ReLU ceiling of the accumulator values
+constexpr int NNUE_WEIGHT_SCALE = 64;     // Quantisation of the output weights
+constexpr int NNUE_OUTPUT_SCALE = 400;    // Network output units to centipawns
+
+/**
+ * @brief First-layer sums for both perspectives. Only the first hidden_size values of each row
+ * are used.
+ */
+struct alignas(64) NnueAccumulator {
+  int16_t values[2][NNUE_MAX_HIDDEN]; // [PieceColor] perspective
+};
+
+/**
+ * @brief Pieces a move adds to and removes from the board, collected before the move is made
+ * so the accumulator can be updated afterwards.
+ */
+struct NnueDirty {
+  struct Change {
+    PieceColor color;
+    PieceType type;
+    Square square;
+  };
+
+  Change added[2]{};
+  Change removed[2]{};
+  int added_count = 0;
+  int removed_count = 0;
+  PieceColor king_moved = ANY; // Colour whose king moved, its perspective needs a full refresh
+};
+
+/**
+ * @brief Efficiently updatable evaluation network: a HalfKP feature transformer into two int16
+ * accumulators, a clipped ReLU and a single output neuron over both perspectives, side to move
+ * first. Read-only once loaded, so every search thread can share one instance.
+ *
+ * File layout, little endian: the 8-byte magic "CLESSNN1", uint32 input count (must be
+ * NNUE_INPUTS), uint32 hidden size (a multiple of 16 up to NNUE_MAX_HIDDEN), int16 biases
+ * [hidden], int16 feature weights [inputs][hidden], int16 output weights [2 * hidden] and an
+ * int32 output bias.
+ */
+class NnueNetwork {
+public:
+  /** @brief Load a network; throws std::runtime_error if it is missing or malformed. */
+  explicit NnueNetwork(const std::string &path);
+  explicit NnueNetwork(std::istream &stream);
+
+  int hidden_size() const { return hidden; }
+
+  void refresh(const Position &position, NnueAccumulator &accumulator) const;
+  void refresh(
+      const Position &position,
+      PieceColor perspective,
+      NnueAccumulator &accumulator
+  ) const;
+
+  /**
+   * @brief Build the accumulator of the position after a move from its parent's, adding and
+   * subtracting one weight column per changed piece.
+   */
+  void update(
+      const Position &position,
+      const NnueDirty &dirty,
+      const NnueAccumulator &parent,
+      NnueAccumulator &child
+  ) const;
+
+  /** @brief Centipawns from the side to move's point of view. */
+  int evaluate(const Position &position, const NnueAccumulator &accumulator) const;
+
+  static NnueDirty dirty_pieces(const Position &position, const Move &move);
+
+private:
+  int hidden = 0;
+  std::vector<int16_t> feature_biases;  // [hidden]
+  std::vector<int16_t> feature_weights; // [NNUE_INPUTS][hidden]
+  std::vector<int16_t> output_weights;  // [2 * hidden]
+  int32_t output_bias = 0;
+
+  void load(std::istream &stream);
+  const int16_t *column(PieceColor perspective, Square king, const NnueDirty::Change &piece) const;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+
+#include <string>
+#include <string_view>
+
+std::string square_to_string(Square square);
+std::string move_to_uci(const Move &move);
+bool uci_to_move(std::string_view uci, const MoveList &legal_moves, Move &move);
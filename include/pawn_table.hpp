@@ -0,0 +1,42 @@
+#pragma once
+
+#include "chess_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Pawn-structure terms of one pawn configuration, white's point of view. The king shelter
+ * also depends on where the king stands, so it is cached per side together with the king square
+ * it was computed for.
+ */
+struct PawnEntry {
+  uint64_t key = 0; // Position::pawn_key
+  int mg = 0;
+  int eg = 0;
+  uint64_t passed[2]{}; // [PieceColor] passed pawns
+
+  Square shelter_king[2] = {NO_SQUARE, NO_SQUARE}; // [PieceColor] king square of shelter
+  int shelter[2]{};                                // [PieceColor] middlegame shelter bonus
+};
+
+/**
+ * @brief Direct-mapped pawn-structure cache. Each search thread owns one, so it needs no
+ * synchronisation; a colliding configuration simply overwrites the slot.
+ */
+class PawnTable {
+public:
+  PawnTable(size_t entry_count = 1 << 14);
+
+  /** @brief Slot for key; found tells whether it already holds that configuration. */
+  PawnEntry &probe(uint64_t key, bool &found);
+  void clear();
+
+  uint64_t probes = 0;
+  uint64_t hits = 0;
+
+private:
+  std::unique_ptr<PawnEntry[]> entries;
+  size_t mask = 0;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "move_gen.hpp"
+#include "position.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct PerftOptions {
+  int threads = 1;     // 0 uses every hardware thread
+  int split_depth = 2; // Plies expanded on the calling thread before handing out tasks
+  size_t hash_mb = 0;  // Subtree count cache size, 0 disables it
+};
+
+struct PerftResult {
+  uint64_t nodes = 0;
+  double seconds = 0.0;
+  double nodes_per_second = 0.0;
+
+  uint64_t hash_probes = 0;
+  uint64_t hash_hits = 0;
+
+  double hash_hit_rate() const { return hash_probes ? double(hash_hits) / hash_probes : 0.0; }
+};
+
+/**
+ * @brief Move-type breakdown of the moves played at the last ply, as in the reference perft tables.
+ * A discovered check is one where none of the checking pieces is a piece that moved.
+ */
+struct PerftStats {
+  uint64_t nodes = 0;
+  uint64_t captures = 0;
+  uint64_t en_passants = 0;
+  uint64_t castles = 0;
+  uint64_t promotions = 0;
+  uint64_t checks = 0;
+  uint64_t discovered_checks = 0;
+  uint64_t double_checks = 0;
+  uint64_t checkmates = 0;
+
+  PerftStats &operator+=(const PerftStats &other);
+};
+
+struct DivideEntry {
+  Move move;
+  PerftStats stats; // Only nodes is filled unless statistics were requested
+};
+
+/**
+ * @brief Shared (Zobrist key, depth) -> node count cache. Entries are stored as key ^ data next to
+ * data, so a torn read from a concurrent writer fails verification instead of returning a wrong
+ * count, and no locks are needed.
+ */
+class PerftTable {
+public:
+  PerftTable(size_t size_mb);
+
+  bool probe(uint64_t key, int depth, uint64_t &nodes) const;
+  void store(uint64_t key, int depth, uint64_t nodes);
+
+private:
+  struct Entry {
+    std::atomic<uint64_t> check{0}; // key ^ data
+    std::atomic<uint64_t> data{0};  // nodes << 8 | depth
+  };
+
+  struct alignas(64) Bucket {
+    Entry entries[4];
+  };
+
+  std::unique_ptr<Bucket[]> buckets;
+  size_t bucket_mask = 0;
+
+  Bucket &bucket_for(uint64_t key) const { return buckets[key & bucket_mask]; }
+};
+
+/**
+ * @brief Move path enumeration. Counts are exact and independent of the thread count.
+ */
+class Perft {
+public:
+  Perft(const PerftOptions &options = {}) : options(options) {}
+
+  PerftResult run(const Position &position, int depth) const;
+  uint64_t count(Position &position, int depth) const;
+  PerftStats count_stats(Position &position, int depth) const;
+  std::vector<DivideEntry> divide(
+      const Position &position,
+      int depth,
+      bool with_stats,
+      PerftResult *totals = nullptr
+  ) const;
+
+private:
+  struct Counters {
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+  };
+
+  PerftOptions options;
+  MoveGenerator generator;
+
+  void classify_move(Position &position, const Move &move, PerftStats &stats) const;
+  uint64_t dispatch(
+      const Position &position,
+      int depth,
+      PerftTable *table,
+      Counters &counters
+  ) const;
+  uint64_t count_nodes(Position &position, int depth, PerftTable *table, Counters &counters) const;
+  uint64_t run_parallel(
+      const Position &position,
+      int depth,
+      PerftTable *table,
+      Counters &counters
+  ) const;
+};
@@ -1,32 +1,46 @@
 #pragma once
 
 #include "chess_types.hpp"
+#include "psqt.hpp"
 
-#include <optional>
+#include <cstdint>
 #include <string>
-#include <vector>
+#include <type_traits>
 
+/**
+ * @brief State that cannot be recovered from the move alone, kept compact so the undo stack can
+ * live inline in Position.
+ */
 struct UndoInfo {
+  uint64_t key{}; // Zobrist key before the move, also the repetition history
+
   Move move{};
   uint8_t captured_piece_encoded{};
 
   uint8_t castling_rights{};
-  std::optional<Square> en_passant_square{};
-  int halfmove_clock{};
-  int fullmove_counter{};
+  Square en_passant_square = NO_SQUARE;
+  uint16_t halfmove_clock{};
 };
 
-class Position {
+/**
+ * @brief Board state with an inline, fixed-capacity history. It is trivially copyable, so search
+ * and perft threads can snapshot it with a plain memcpy and no heap traffic.
+ */
+class alignas(64) Position {
 public:
   Position(const std::string &fen) { set_fen(fen); }
 
-  PieceColor to_move{};
   uint64_t bitboards[12]{};   // [BitboardIndex]
   uint64_t occupancy[3]{};    // [PieceColor]
   uint8_t lookup_table[64]{}; // Encoded pieces
 
+  uint64_t key{};       // Zobrist key of the full position
+  uint64_t pawn_key{};  // Zobrist key of the pawns only
+  PsqAccumulator psq{}; // Tapered material and piece-square totals
+
+  PieceColor to_move{};
   uint8_t castling_rights{};
-  std::optional<Square> en_passant_square{};
+  Square en_passant_square = NO_SQUARE;
   int halfmove_clock{};
   int fullmove_counter{};
 
@@ -34,16 +48,34 @@ public:
   std::string get_fen() const;
 
   Piece get_piece_at(Square square) const;
+  uint64_t compute_key() const;
+  uint64_t compute_pawn_key() const;
+  PsqAccumulator compute_psq() const;
+  int count_repetitions() const;
+  int get_history_length() const { return undo_count; } // Moves that can be undone
+  bool has_insufficient_material() const;
   void make_move(const Move &move);
   void undo_move();
+  void make_null_move();
+  void undo_null_move();
 
 private:
-  std::vector<UndoInfo> undo_stack{};
+  int undo_count = 0;
+  UndoInfo undo_stack[MAX_POSITION_PLIES];
 
   Square get_captured_square(const Move &move) const;
+  bool can_capture_en_passant(Square pushed_pawn, PieceColor capturer) const;
   void push_undo_info(const Move &move, uint8_t captured_piece_encoded);
   void update_castling_rights(const Move &move, const Piece &piece, Square captured_square);
   void add_piece(PieceColor color, PieceType piece, Square square);
   void remove_piece(PieceColor color, PieceType piece, Square square);
   void pass_turn();
 };
+
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be copyable with memcpy");
+
+/**
+ * @brief Whether fen is well formed and has exactly one king per side, which set_fen and move
+ * generation assume without checking.
+ */
+bool is_valid_fen(const std::string &fen);
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "chess_types.hpp"
+
+#include <cstdint>
+
+constexpr int MATERIAL_MG[7] = {0, 100, 320, 330, 500, 900, 0}; // [PieceType], centipawns
+constexpr int MATERIAL_EG[7] = {0, 120, 290, 310, 540, 940, 0}; // [PieceType], centipawns
+
+constexpr int PHASE_WEIGHTS[7] = {0, 0, 1, 1, 2, 4, 0}; // [PieceType]
+constexpr int MAX_PHASE = 24;                           // Phase of the starting position
+
+namespace psqt_detail {
+
+// clang-format off
+// Piece-square bonuses for white, laid out as seen from white's side (a8 first)
+constexpr int PAWN_MG[64] = {
+   0,  0,  0,  0,  0,  0,  0,  0,
+  50, 50, 50, 50, 50, 50, 50, 50,
+  10, 10, 20, 30, 30, 20, 10, 10,
+   5,  5, 10, 25, 25, 10,  5,  5,
+   0,  0,  0, 20, 20,  0,  0,  0,
+   5, -5,-10,  0,  0,-10, -5,  5,
+   5, 10, 10,-20,-20, 10, 10,  5,
+   0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+constexpr int PAWN_EG[64] = {
+   0,  0,  0,  0,  0,  0,  0,  0,
+  90, 90, 85, 80, 80, 85, 90, 90,
+  50, 50, 45, 40, 40, 45, 50, 50,
+  25, 25, 20, 15, 15, 20, 25, 25,
+  10, 10,  5,  5,  5,  5, 10, 10,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+constexpr int KNIGHT_PSQ[64] = {
+  -50,-40,-30,-30,-30,-30,-40,-50,
+  -40,-20,  0,  0,  0,  0,-20,-40,
+  -30,  0, 10, 15, 15, 10,  0,-30,
+  -30,  5, 15, 20, 20, 15,  5,-30,
+  -30,  0, 15, 20, 20, 15,  0,-30,
+  -30,  5, 10, 15, 15, 10,  5,-30,
+  -40,-20,  0,  5,  5,  0,-20,-40,
+  -50,-40,-30,-30,-30,-30,-40,-50,
+};
+
+constexpr int BISHOP_PSQ[64] = {
+  -20,-10,-10,-10,-10,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5, 10, 10,  5,  0,-10,
+  -10,  5,  5, 10, 10,  5,  5,-10,
+  -10,  0, 10, 10, 10, 10,  0,-10,
+  -10, 10, 10, 10, 10, 10, 10,-10,
+  -10,  5,  0,  0,  0,  0,  5,-10,
+  -20,-10,-10,-10,-10,-10,-10,-20,
+};
+
+constexpr int ROOK_PSQ[64] = {
+   0,  0,  0,  0,  0,  0,  0,  0,
+   5, 10, 10, 10, 10, 10, 10,  5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+   0,  0,  0,  5,  5,  0,  0,  0,
+};
+
+constexpr int QUEEN_PSQ[64] = {
+  -20,-10,-10, -5, -5,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5,  5,  5,  5,  0,-10,
+   -5,  0,  5,  5,  5,  5,  0, -5,
+    0,  0,  5,  5,  5,  5,  0, -5,
+  -10,  5,  5,  5,  5,  5,  0,-10,
+  -10,  0,  5,  0,  0,  0,  0,-10,
+  -20,-10,-10, -5, -5,-10,-10,-20,
+};
+
+constexpr int KING_MG[64] = {
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -20,-30,-30,-40,-40,-30,-30,-20,
+  -10,-20,-20,-20,-20,-20,-20,-10,
+   20, 20,  0,  0,  0,  0, 20, 20,
+   20, 30, 10,  0,  0, 10, 30, 20,
+};
+
+constexpr int KING_EG[64] = {
+  -50,-40,-30,-20,-20,-30,-40,-50,
+  -30,-20,-10,  0,  0,-10,-20,-30,
+  -30,-10, 20, 30, 30, 20,-10,-30,
+  -30,-10, 30, 40, 40, 30,-10,-30,
+  -30,-10, 30, 40, 40, 30,-10,-30,
+  -30,-10, 20, 30, 30, 20,-10,-30,
+  -30,-30,  0,  0,  0,  0,-30,-30,
+  -50,-30,-30,-30,-30,-30,-30,-50,
+};
+// clang-format on
+
+constexpr const int *TABLES_MG[7] = {
+    nullptr, PAWN_MG, KNIGHT_PSQ, BISHOP_PSQ, ROOK_PSQ, QUEEN_PSQ, KING_MG,
+};
+
+constexpr const int *TABLES_EG[7] = {
+    nullptr, PAWN_EG, KNIGHT_PSQ, BISHOP_PSQ, ROOK_PSQ, QUEEN_PSQ, KING_EG,
+};
+
+} // namespace psqt_detail
+
+struct PsqTables {
+  int16_t mg[12][64]; // [BitboardIndex][Square], material included, signed for white
+  int16_t eg[12][64]; // [BitboardIndex][Square], material included, signed for white
+};
+
+/**
+ * @brief Fold material into the piece-square tables and mirror them for black, so a piece's whole
+ * contribution is a single signed lookup.
+ */
+constexpr PsqTables init_psq_tables() {
+  PsqTables tables{};
+
+  for (int type = PIECE_PAWN; type <= PIECE_KING; type++) {
+    const PieceType piece = static_cast<PieceType>(type);
+    for (int square = 0; square < 64; square++) {
+      const int white_mg = MATERIAL_MG[type] + psqt_detail::TABLES_MG[type][square ^ 56];
+      const int white_eg = MATERIAL_EG[type] + psqt_detail::TABLES_EG[type][square ^ 56];
+      const int black_mg = MATERIAL_MG[type] + psqt_detail::TABLES_MG[type][square];
+      const int black_eg = MATERIAL_EG[type] + psqt_detail::TABLES_EG[type][square];
+
+      tables.mg[bitboard_index(WHITE, piece)][square] = static_cast<int16_t>(white_mg);
+      tables.eg[bitboard_index(WHITE, piece)][square] = static_cast<int16_t>(white_eg);
+      tables.mg[bitboard_index(BLACK, piece)][square] = static_cast<int16_t>(-black_mg);
+      tables.eg[bitboard_index(BLACK, piece)][square] = static_cast<int16_t>(-black_eg);
+    }
+  }
+
+  return tables;
+}
+
+inline constexpr PsqTables PSQ = init_psq_tables();
+
+/**
+ * @brief Running material and piece-square totals from white's point of view, kept up to date
+ * by Position as pieces are added and removed.
+ */
+struct PsqAccumulator {
+  int mg{};
+  int eg{};
+  int phase{}; // Sum of PHASE_WEIGHTS over the pieces on the board, above MAX_PHASE if promoted
+
+  bool operator==(const PsqAccumulator &other) const {
+    return mg == other.mg && eg == other.eg && phase == other.phase;
+  }
+};
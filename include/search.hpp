@@ -0,0 +1,151 @@
+#pragma once
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "move_picker.hpp"
+#include "nnue.hpp"
+#include "pawn_table.hpp"
+#include "position.hpp"
+#include "thread_pool.hpp"
+#include "transposition.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr int MATE_SCORE = 30000;
+constexpr int INFINITE_SCORE = 32000;
+
+/**
+ * @brief Selective search techniques, each switchable so its effect on time-to-depth and
+ * tactical strength can be measured on its own.
+ */
+struct SearchFeatures {
+  bool pvs = true;                  // Null-window scout search for every move after the first
+  bool aspiration = true;           // Narrow root window around the previous iteration's score
+  bool null_move = true;            // Cut when passing the turn still fails high
+  bool late_move_reductions = true; // Search late quiet moves shallower first
+  bool futility = true;             // Futility and reverse futility pruning near the leaves
+  bool check_extensions = true;     // Search one ply deeper when in check
+};
+
+struct SearchOptions {
+  size_t hash_mb = 16;     // Transposition table size
+  int threads = 1;         // 1 is deterministic for depth and node limits, 0 uses every core
+  std::string nnue_file;   // Network weights, empty uses the classical evaluation
+  SearchFeatures features; // All enabled by default
+};
+
+struct SearchLimits {
+  int depth = MAX_SEARCH_PLY - 1; // Iterative deepening stops after this many plies
+  uint64_t nodes = 0;             // 0 means no node limit
+  int time_ms = 0;                // Hard limit, 0 means no time limit
+  int soft_time_ms = 0;           // No new iteration past this, scaled by best-move stability
+
+  const std::atomic<bool> *stop = nullptr; // Caller's stop signal, polled like Search::stop
+};
+
+struct SearchResult {
+  Move best_move{};
+  int score = 0; // Centipawns from the side to move's point of view
+  int depth = 0; // Deepest fully completed iteration
+  uint64_t nodes = 0;
+  double seconds = 0.0;
+  std::vector<Move> pv; // Empty when the root has no legal moves
+
+  uint64_t tt_probes = 0;
+  uint64_t tt_hits = 0;
+  int hashfull = 0; // Permille of the table written during this search
+
+  uint64_t pawn_probes = 0;
+  uint64_t pawn_hits = 0;
+
+  double tt_hit_rate() const { return tt_probes ? double(tt_hits) / tt_probes : 0.0; }
+  double pawn_hit_rate() const { return pawn_probes ? double(pawn_hits) / pawn_probes : 0.0; }
+
+  bool is_mate_score() const {
+    return score >= MATE_SCORE - MAX_SEARCH_PLY || score <= -MATE_SCORE + MAX_SEARCH_PLY;
+  }
+};
+
+/**
+ * @brief In-process engine: iterative-deepening negamax with alpha-beta, a quiescence search over
+ * captures and promotions, and a triangular principal variation table. With several threads it
+ * runs Lazy SMP: helpers search the same root at staggered depths and share only the
+ * transposition table, the calling thread's result is returned.
+ */
+class Search {
+public:
+  /** @brief Loads the NNUE file if one is given; throws std::runtime_error if it cannot. */
+  Search(const SearchOptions &options = {});
+
+  SearchResult run(const Position &position, const SearchLimits &limits);
+  void clear();
+
+  /** @brief Switch selective techniques on or off; applies from the next run. */
+  void set_features(const SearchFeatures &features) { options.features = features; }
+
+  /** @brief Ask a running search to return its best move so far; safe from any thread. */
+  void stop() { stop_requested.store(true, std::memory_order_relaxed); }
+
+private:
+  /**
+   * @brief Everything one search thread writes. Kept on the heap since the per-ply move pickers
+   * are large.
+   */
+  struct Worker {
+    Worker(int id) : id(id), position(INITIAL_POSITION_FEN) {}
+
+    int id;
+    Position position;
+    std::atomic<uint64_t> nodes{0}; // Written by its own thread only, read by the main thread
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    bool stopped = false;
+    SearchResult result{};
+
+    MovePicker pickers[MAX_SEARCH_PLY]{}; // One per ply, holds that ply's generated moves
+    Move killers[MAX_SEARCH_PLY][2]{};
+    MovePicker::History history{};
+    PawnTable pawn_table;
+    NnueAccumulator accumulators[MAX_SEARCH_PLY + 1]; // [ply], only maintained with a network
+
+    Move pv_table[MAX_SEARCH_PLY][MAX_SEARCH_PLY]{};
+    int pv_length[MAX_SEARCH_PLY]{};
+    Move previous_pv[MAX_SEARCH_PLY]{};
+    int previous_pv_length = 0;
+    bool follow_pv = false;
+
+    void count_node() {
+      nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  };
+
+  SearchOptions options;
+  MoveGenerator generator;
+  std::shared_ptr<const NnueNetwork> network; // Shared read-only by every worker
+  std::unique_ptr<TranspositionTable> tt;     // Allocated on first use, kept between searches
+  std::unique_ptr<ThreadPool> helpers;        // Lazy SMP helper threads, created on first use
+  std::vector<std::unique_ptr<Worker>> workers;
+  int thread_count = 1;
+  std::atomic<bool> stop_requested{false};
+
+  SearchLimits limits{};
+  std::chrono::steady_clock::time_point start_time{};
+
+  void iterate(Worker &worker);
+  int aspiration_search(Worker &worker, int depth, int previous_score);
+  int negamax(Worker &worker, int depth, int ply, int alpha, int beta, bool allow_null = true);
+  int quiescence(Worker &worker, int ply, int alpha, int beta);
+  void make_move(Worker &worker, const Move &move, int ply) const;
+  int static_eval(Worker &worker, int ply) const;
+  void update_quiet_stats(Worker &worker, const Move &move, int depth, int ply);
+  bool is_draw(const Position &position) const;
+  bool should_stop(Worker &worker);
+  bool soft_limit_reached(int stable_iterations) const;
+  uint64_t total_nodes() const;
+};
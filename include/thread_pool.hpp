@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool where every worker owns a deque. Workers take their own newest task first
+ * and steal the oldest task of another worker when they run dry, so uneven tasks balance out.
+ */
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  ThreadPool(int thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(Task task);
+  void wait_idle();
+  int size() const { return static_cast<int>(workers.size()); }
+
+  int current_worker() const;
+
+private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex state_mutex;
+  std::condition_variable work_available;
+  std::condition_variable all_done;
+  int queued = 0;  // Submitted, not yet claimed by a worker
+  int pending = 0; // Submitted, not yet finished
+  bool stopping = false;
+  std::atomic<unsigned> next_queue{0};
+
+  bool try_pop(int index, Task &task);
+  void worker_loop(int index);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "chess_types.hpp"
+
+#include <chrono>
+#include <string>
+
+constexpr int DEFAULT_MOVES_TO_GO = 30;           // Assumed moves left in sudden death
+constexpr int MOVE_OVERHEAD_MS = 50;              // Kept back for UI and pipe latency
+constexpr int MAX_CLOCK_MS = 24 * 60 * 60 * 1000; // A day, far from int overflow in any sum
+
+struct TimeControl {
+  int base_ms = 3 * 60 * 1000; // Starting time of each side
+  int increment_ms = 2000;     // Added after every move
+  int moves_to_go = 0;         // Moves until the next time control, 0 for sudden death
+};
+
+/**
+ * @brief Both sides' game clocks. The side to move's clock runs from the last move, or the start
+ * of the game, until it moves; it is charged then and credited its increment.
+ */
+class GameClock {
+public:
+  GameClock(const TimeControl &control = {}) { reset(control); }
+
+  void reset(const TimeControl &control);
+
+  /** @brief Stop the running clock, charge the side that moved and start the other one. */
+  void press(PieceColor mover);
+
+  /** @brief Remaining time, counting the running clock up to now if it belongs to color. */
+  int remaining_ms(PieceColor color) const;
+  int increment_ms(PieceColor color) const { return increment[color]; }
+  int moves_to_go(PieceColor color) const;
+
+  /** @brief Start the running clock over without charging anyone, e.g. after an undo. */
+  void restart_turn() { turn_start = std::chrono::steady_clock::now(); }
+
+private:
+  TimeControl control{};
+  int remaining[2]{};
+  int increment[2]{};
+  int moves_made[2]{};
+  PieceColor running = WHITE;
+  std::chrono::steady_clock::time_point turn_start = std::chrono::steady_clock::now();
+};
+
+/**
+ * @brief Thinking time for one move. Iterative deepening may stop after an iteration once the
+ * soft limit is used up, sooner for a stable best move; the hard limit interrupts the search.
+ */
+struct TimeBudget {
+  int soft_ms = 0;
+  int hard_ms = 0;
+};
+
+TimeBudget allocate_time(int remaining_ms, int increment_ms, int moves_to_go = 0);
+TimeBudget allocate_time(const GameClock &clock, PieceColor side);
+
+/**
+ * @brief Parse "minutes+seconds", e.g. "5+3"; the increment is optional. Returns false and leaves
+ * control unchanged for malformed, non-finite or negative values and times above MAX_CLOCK_MS.
+ */
+bool parse_time_control(const std::string &value, TimeControl &control);
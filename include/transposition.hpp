@@ -0,0 +1,61 @@
+#pragma once
+
+#include "chess_types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum Bound : uint8_t {
+  BOUND_NONE,
+  BOUND_UPPER, // Fail low, the score is at most this
+  BOUND_LOWER, // Fail high, the score is at least this
+  BOUND_EXACT
+};
+
+struct TTEntry {
+  uint16_t move = 0; // See encode_move, 0 when no move is known
+  int16_t score = 0;
+  uint8_t depth = 0;
+  Bound bound = BOUND_NONE;
+};
+
+/**
+ * @brief Search cache shared by every search thread. Each 64-byte bucket holds four entries stored
+ * as key ^ data next to data, so a torn read from a concurrent writer fails verification instead
+ * of returning another position's score, and no locks are needed.
+ */
+class TranspositionTable {
+public:
+  TranspositionTable(size_t size_mb);
+
+  void clear();
+  void new_search() { age = (age + 1) & AGE_MASK; }
+
+  bool probe(uint64_t key, TTEntry &entry) const;
+  void store(uint64_t key, const TTEntry &entry);
+  void prefetch(uint64_t key) const { __builtin_prefetch(&bucket_for(key)); }
+
+  int hashfull() const; // Permille of sampled entries written by the current search
+
+private:
+  static constexpr uint8_t AGE_MASK = 0x3F;
+
+  struct Entry {
+    std::atomic<uint64_t> check{0}; // key ^ data
+    std::atomic<uint64_t> data{0};  // move | score << 16 | depth << 32 | bound << 40 | age << 42
+  };
+
+  struct alignas(64) Bucket {
+    Entry entries[4];
+  };
+
+  std::unique_ptr<Bucket[]> buckets;
+  size_t bucket_mask = 0;
+  uint8_t age = 0;
+
+  Bucket &bucket_for(uint64_t key) const { return buckets[key & bucket_mask]; }
+  static uint64_t pack(const TTEntry &entry, uint8_t age);
+  static TTEntry unpack(uint64_t data);
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+#include "transposition.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+constexpr int UCI_INFO_MAX_PV = 32; // Longer principal variations are cut
+
+enum UciInfoField : uint16_t {
+  INFO_DEPTH = 1 << 0,
+  INFO_SELDEPTH = 1 << 1,
+  INFO_MULTIPV = 1 << 2,
+  INFO_SCORE = 1 << 3,
+  INFO_NODES = 1 << 4,
+  INFO_NPS = 1 << 5,
+  INFO_HASHFULL = 1 << 6,
+  INFO_TBHITS = 1 << 7,
+  INFO_TIME = 1 << 8,
+  INFO_PV = 1 << 9
+};
+
+/**
+ * @brief One "info" line of a UCI engine. Only the values flagged in fields were on the line.
+ */
+struct UciInfo {
+  uint16_t fields = 0; // UciInfoField bits
+  int depth = 0;
+  int seldepth = 0;
+  int multipv = 1;
+  int score = 0;             // Centipawns, or moves to mate when mate is set
+  bool mate = false;         // Negative score: the engine is getting mated
+  Bound bound = BOUND_EXACT; // lowerbound / upperbound scores are bounds only
+  uint64_t nodes = 0;
+  uint64_t nps = 0;
+  uint64_t tbhits = 0;
+  int hashfull = 0; // Permille
+  int time_ms = 0;
+
+  Move pv[UCI_INFO_MAX_PV]{}; // Legal from the root, in order
+  int pv_length = 0;
+  bool pv_truncated = false; // Stopped at an illegal or unknown move, or at UCI_INFO_MAX_PV
+
+  bool has(UciInfoField field) const { return (fields & field) != 0; }
+};
+
+/**
+ * @brief Parse an engine output line into info without allocating; false if it is not an "info"
+ * line. PV moves are checked by playing them on root, which is restored before returning. Unknown
+ * keywords are skipped and "string" ends the line.
+ */
+bool parse_uci_info(
+    std::string_view line,
+    Position &root,
+    const MoveGenerator &generator,
+    UciInfo &info
+);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "chess_types.hpp"
+
+#include <cstdint>
+
+struct ZobristKeys {
+  uint64_t pieces[12][64]; // [BitboardIndex][Square]
+  uint64_t castling[16];   // [castling rights mask]
+  uint64_t en_passant[8];  // [file]
+  uint64_t side;           // Black to move
+};
+
+/**
+ * @brief splitmix64 step, used to fill the key table at compile time.
+ */
+constexpr uint64_t zobrist_next(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys init_zobrist_keys() {
+  ZobristKeys keys{};
+  uint64_t state = 0x636C657373ULL; // "cless"
+
+  for (int piece = 0; piece < 12; piece++) {
+    for (int square = 0; square < 64; square++) {
+      keys.pieces[piece][square] = zobrist_next(state);
+    }
+  }
+
+  // Combined rights hash as the XOR of their single-right keys so updates stay incremental
+  uint64_t single_rights[4]{};
+  for (int right = 0; right < 4; right++) {
+    single_rights[right] = zobrist_next(state);
+  }
+  for (int rights = 0; rights < 16; rights++) {
+    for (int right = 0; right < 4; right++) {
+      if (rights & (1 << right)) keys.castling[rights] ^= single_rights[right];
+    }
+  }
+
+  for (int file = 0; file < 8; file++) {
+    keys.en_passant[file] = zobrist_next(state);
+  }
+
+  keys.side = zobrist_next(state);
+  return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = init_zobrist_keys();
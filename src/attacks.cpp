@@ -1,6 +1,20 @@
-
 #include "attacks.hpp"
 
+#include <cstdint>
+
+Magic ROOK_MAGICS[64];
+Magic BISHOP_MAGICS[64];
+uint64_t BETWEEN_BB[64][64];
+uint64_t LINE_BB[64][64];
+
+namespace {
+
+uint64_t ROOK_TABLE[0x19000];  // Sum of 2^popcount(mask) over all rook squares
+uint64_t BISHOP_TABLE[0x1480]; // Sum of 2^popcount(mask) over all bishop squares
+
+/**
+ * @brief Reference ray walker, only used to fill the lookup tables.
+ */
 uint64_t scan_attacks(int square, uint64_t occupancy, int rank_dir, int file_dir) {
   uint64_t attacks = 0ULL;
   int piece_rank = square_rank(square);
@@ -20,20 +34,122 @@ uint64_t scan_attacks(int square, uint64_t occupancy, int rank_dir, int file_dir
   return attacks;
 }
 
-uint64_t get_rook_attacks(int square, uint64_t occupancy) {
-  uint64_t attacks = 0ULL;
-  attacks |= scan_attacks(square, occupancy, 0, -1);
-  attacks |= scan_attacks(square, occupancy, 0, 1);
-  attacks |= scan_attacks(square, occupancy, -1, 0);
-  attacks |= scan_attacks(square, occupancy, 1, 0);
-  return attacks;
+uint64_t scan_rook_attacks(int square, uint64_t occupancy) {
+  return scan_attacks(square, occupancy, 0, -1) | scan_attacks(square, occupancy, 0, 1)
+         | scan_attacks(square, occupancy, -1, 0) | scan_attacks(square, occupancy, 1, 0);
 }
 
-uint64_t get_bishop_attacks(int square, uint64_t occupancy) {
-  uint64_t attacks = 0ULL;
-  attacks |= scan_attacks(square, occupancy, 1, 1);
-  attacks |= scan_attacks(square, occupancy, 1, -1);
-  attacks |= scan_attacks(square, occupancy, -1, 1);
-  attacks |= scan_attacks(square, occupancy, -1, -1);
-  return attacks;
+uint64_t scan_bishop_attacks(int square, uint64_t occupancy) {
+  return scan_attacks(square, occupancy, 1, 1) | scan_attacks(square, occupancy, 1, -1)
+         | scan_attacks(square, occupancy, -1, 1) | scan_attacks(square, occupancy, -1, -1);
+}
+
+/**
+ * @brief xorshift64* generator, seeded per rank so the magic search is deterministic.
+ */
+struct MagicRng {
+  uint64_t state;
+
+  uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+  }
+
+  uint64_t sparse() { return next() & next() & next(); }
+};
+
+/**
+ * @brief Fill the magic entries and attack table for one slider type.
+ *
+ * @param magics Per-square entries to fill
+ * @param table Shared attack table, sliced between squares
+ * @param scan Reference attack generator used to build the table
+ */
+void init_magics(Magic magics[64], uint64_t *table, uint64_t (*scan)(int, uint64_t)) {
+  constexpr uint64_t SEEDS[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+  uint64_t occupancies[4096], references[4096];
+  int epoch[4096] = {}, attempt = 0;
+  uint64_t *slice = table;
+
+  for (int square = 0; square < 64; square++) {
+    const uint64_t rank_edges = (RANK_1 | RANK_8) & ~(RANK_1 << (8 * square_rank(square)));
+    const uint64_t file_edges = (FILE_A | FILE_H) & ~(FILE_A << square_file(square));
+
+    Magic &entry = magics[square];
+    entry.mask = scan(square, 0) & ~(rank_edges | file_edges);
+    entry.shift = 64 - count_bits(entry.mask);
+    entry.attacks = slice;
+
+    // Carry-Rippler enumeration of every subset of the mask
+    int size = 0;
+    uint64_t subset = 0;
+    do {
+      occupancies[size] = subset;
+      references[size] = scan(square, subset);
+      size++;
+      subset = (subset - entry.mask) & entry.mask;
+    } while (subset);
+
+    slice += size;
+
+#ifdef USE_PEXT
+    for (int i = 0; i < size; i++) {
+      entry.attacks[entry.index(occupancies[i])] = references[i];
+    }
+#else
+    MagicRng rng{SEEDS[square_rank(square)]};
+    for (int i = 0; i < size;) {
+      do {
+        entry.magic = rng.sparse();
+      } while (count_bits((entry.magic * entry.mask) >> 56) < 6);
+
+      // Epochs avoid clearing the slice between failed candidates
+      attempt++;
+      for (i = 0; i < size; i++) {
+        unsigned index = entry.index(occupancies[i]);
+
+        if (epoch[index] < attempt) {
+          epoch[index] = attempt;
+          entry.attacks[index] = references[i];
+        } else if (entry.attacks[index] != references[i]) {
+          break;
+        }
+      }
+    }
+#endif
+  }
 }
+
+void init_lines() {
+  for (int from = 0; from < 64; from++) {
+    for (int to = 0; to < 64; to++) {
+      if (from == to) continue;
+
+      const uint64_t to_bit = 1ULL << to;
+      const uint64_t from_bit = 1ULL << from;
+
+      if (get_rook_attacks(from, 0) & to_bit) {
+        LINE_BB[from][to] =
+            (get_rook_attacks(from, 0) & get_rook_attacks(to, 0)) | from_bit | to_bit;
+        BETWEEN_BB[from][to] = get_rook_attacks(from, to_bit) & get_rook_attacks(to, from_bit);
+      } else if (get_bishop_attacks(from, 0) & to_bit) {
+        LINE_BB[from][to] =
+            (get_bishop_attacks(from, 0) & get_bishop_attacks(to, 0)) | from_bit | to_bit;
+        BETWEEN_BB[from][to] = get_bishop_attacks(from, to_bit) & get_bishop_attacks(to, from_bit);
+      }
+    }
+  }
+}
+
+struct MagicInitializer {
+  MagicInitializer() {
+    init_magics(ROOK_MAGICS, ROOK_TABLE, scan_rook_attacks);
+    init_magics(BISHOP_MAGICS, BISHOP_TABLE, scan_bishop_attacks);
+    init_lines();
+  }
+} magic_initializer;
+
+} // namespace
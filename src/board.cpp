@@ -2,9 +2,12 @@
 
 #include "chess_types.hpp"
 #include "game_logic.hpp"
+#include "uci_info.hpp"
 #include "utils.hpp"
 
+#include <cstdio>
 #include <ncurses.h>
+#include <optional>
 #include <string>
 
 #define title_padding padding
@@ -23,7 +26,9 @@ void BoardWin::draw_panel() {
     if (promotion_move.has_value()) {
       Move move = promotion_move.value();
       move.promotion_piece = chosen_piece;
-      state.game.make_move(move);
+      if (state.game.make_move(move) && state.game.get_current_mode() == PLAYER_VS_ENGINE) {
+        state.game.start_engine_move();
+      }
     }
 
     promotion_move = std::nullopt;
@@ -57,6 +62,8 @@ void BoardWin::draw_panel() {
 }
 
 void BoardWin::update() {
+  state.game.poll_engine_move(); // The engine replies on its own thread
+
   if (popup_handler.any_visible()) {
     popup_handler.update();
     return;
@@ -81,6 +88,8 @@ void BoardWin::update() {
     case GAME_ONGOING: {
       bool is_white_to_move = (state.game.to_move() == PieceColor::WHITE);
       status_text = is_white_to_move ? "White to move" : "Black to move";
+      if (state.game.is_engine_thinking()) status_text = engine_status();
+      if (state.game.is_engine_pondering()) status_text += " (engine pondering)";
       break;
     }
     case CHECKMATE: {
@@ -91,6 +100,7 @@ void BoardWin::update() {
     case STALEMATE: status_text = "Draw by stalemate"; break;
     case DRAW_INSUFFICIENT_MATERIAL: status_text = "Draw by insufficient material"; break;
     case DRAW_FIFTY_MOVE_RULE: status_text = "Draw by 50-move rule"; break;
+    case DRAW_REPETITION: status_text = "Draw by threefold repetition"; break;
     case DRAW_OTHER: status_text = "Draw"; break;
   }
 
@@ -170,12 +180,31 @@ void BoardWin::handle_input(int pressed_key) {
       highlighted_square = 63 - highlighted_square;
       break;
 
+    case 's': state.game.stop_engine(); break;
     case '?': popup_handler.show_popup("help"); break;
     case 'q': state.next_window = state.menu_win_name; return;
     default: break;
   }
 }
 
+/**
+ * @brief Progress of a thinking engine, with depth and score once an external engine reports them
+ */
+std::string BoardWin::engine_status() {
+  const std::optional<UciInfo> &info = state.game.get_engine_info();
+  if (!info || !info->has(INFO_DEPTH)) return "Engine thinking... (s: move now)";
+
+  char text[64];
+  if (!info->has(INFO_SCORE)) {
+    snprintf(text, sizeof(text), "Depth %d (s: move now)", info->depth);
+  } else if (info->mate) {
+    snprintf(text, sizeof(text), "Depth %d, mate in %d (s: move now)", info->depth, info->score);
+  } else {
+    snprintf(text, sizeof(text), "Depth %d, %+.2f (s: move now)", info->depth, info->score / 100.0);
+  }
+  return text;
+}
+
 /**
  * @brief Handle piece selection and movement logic
  */
@@ -226,7 +255,7 @@ void BoardWin::handle_piece_selection() {
   if (move_successful) {
     selected_square = std::nullopt;
 
-    if (state.game.get_current_mode() == PLAYER_VS_ENGINE) { state.game.make_engine_move(); }
+    if (state.game.get_current_mode() == PLAYER_VS_ENGINE) { state.game.start_engine_move(); }
     return;
   }
 
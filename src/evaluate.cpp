@@ -0,0 +1,292 @@
+#include "evaluate.hpp"
+
+#include "attacks.hpp"
+#include "chess_types.hpp"
+#include "pawn_table.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace {
+
+constexpr auto KNIGHT_ATTACKS = init_knight_attacks();
+constexpr auto KING_ATTACKS = init_king_attacks();
+
+// Per reachable square, [PieceType]
+constexpr int MOBILITY_MG[7] = {0, 0, 4, 5, 2, 1, 0};
+constexpr int MOBILITY_EG[7] = {0, 0, 4, 5, 4, 2, 0};
+
+// Attack units per square of the enemy king zone hit, [PieceType]
+constexpr int KING_ATTACK_UNITS[7] = {0, 0, 2, 2, 3, 5, 0};
+constexpr int MAX_KING_DANGER = 500;
+
+// Pawn structure, [relative rank] where ranks are indexed from the pawn's own side
+constexpr int PASSED_MG[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+constexpr int PASSED_EG[8] = {0, 10, 20, 35, 60, 95, 140, 0};
+constexpr int PASSED_KING_DISTANCE = 4; // Per rank above the fourth, per square of distance
+constexpr int ISOLATED_MG = -10, ISOLATED_EG = -15;
+constexpr int DOUBLED_MG = -10, DOUBLED_EG = -20;
+constexpr int BACKWARD_MG = -8, BACKWARD_EG = -10;
+constexpr int SHELTER_CLOSE = 12, SHELTER_FAR = 6; // Own pawn one or two ranks ahead of the king
+
+struct EvalTerms {
+  int mg = 0;
+  int eg = 0;
+};
+
+uint64_t pawn_attacks(PieceColor color, uint64_t pawns) {
+  if (color == WHITE) return ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9);
+  return ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+}
+
+struct PawnMasks {
+  uint64_t passed_span[2][64];  // [PieceColor][Square] squares ahead on this and adjacent files
+  uint64_t support_span[2][64]; // [PieceColor][Square] adjacent files, level or behind
+  uint64_t adjacent_files[8];   // [File]
+};
+
+constexpr PawnMasks init_pawn_masks() {
+  PawnMasks masks{};
+
+  for (int file = 0; file < 8; file++) {
+    if (file > 0) masks.adjacent_files[file] |= FILE_A << (file - 1);
+    if (file < 7) masks.adjacent_files[file] |= FILE_A << (file + 1);
+  }
+
+  for (int square = 0; square < 64; square++) {
+    const int file = square_file(square);
+    const int rank = square_rank(square);
+    const uint64_t files = masks.adjacent_files[file] | FILE_A << file;
+
+    for (int other = 0; other < 64; other++) {
+      const uint64_t bit = 1ULL << other;
+      const int other_rank = square_rank(other);
+      if (!(files & bit)) continue;
+
+      if (other_rank > rank) masks.passed_span[WHITE][square] |= bit;
+      if (other_rank < rank) masks.passed_span[BLACK][square] |= bit;
+      if (square_file(other) == file) continue;
+      if (other_rank <= rank) masks.support_span[WHITE][square] |= bit;
+      if (other_rank >= rank) masks.support_span[BLACK][square] |= bit;
+    }
+  }
+
+  return masks;
+}
+
+constexpr PawnMasks PAWN_MASKS = init_pawn_masks();
+
+int relative_rank(PieceColor color, int square) {
+  return color == WHITE ? square_rank(square) : 7 - square_rank(square);
+}
+
+int distance(int from, int to) {
+  return std::max(
+      std::abs(square_file(from) - square_file(to)),
+      std::abs(square_rank(from) - square_rank(to))
+  );
+}
+
+/**
+ * @brief Passed, isolated, doubled and backward pawns of one side. Depends on the pawns alone, so
+ * the result can be cached under the pawn key.
+ */
+EvalTerms pawn_structure(const Position &position, PieceColor us, uint64_t &passed) {
+  const PieceColor them = opposite_color(us);
+  const uint64_t our_pawns = position.bitboards[bitboard_index(us, PIECE_PAWN)];
+  const uint64_t their_pawns = position.bitboards[bitboard_index(them, PIECE_PAWN)];
+  const int forward = us == WHITE ? 8 : -8;
+
+  EvalTerms terms;
+  passed = 0;
+
+  uint64_t pawns = our_pawns;
+  while (pawns) {
+    const int square = pop_lsb(pawns);
+    const int file = square_file(square);
+    const uint64_t ahead = PAWN_MASKS.passed_span[us][square] & (FILE_A << file);
+
+    if (!(PAWN_MASKS.passed_span[us][square] & their_pawns) && !(ahead & our_pawns)) {
+      passed |= 1ULL << square;
+      terms.mg += PASSED_MG[relative_rank(us, square)];
+      terms.eg += PASSED_EG[relative_rank(us, square)];
+    }
+
+    if (ahead & our_pawns) {
+      terms.mg += DOUBLED_MG;
+      terms.eg += DOUBLED_EG;
+    }
+
+    if (!(PAWN_MASKS.adjacent_files[file] & our_pawns)) {
+      terms.mg += ISOLATED_MG;
+      terms.eg += ISOLATED_EG;
+    } else if (!(PAWN_MASKS.support_span[us][square] & our_pawns)) {
+      const uint64_t stop = 1ULL << (square + forward);
+      if (pawn_attacks(them, their_pawns) & stop) {
+        terms.mg += BACKWARD_MG;
+        terms.eg += BACKWARD_EG;
+      }
+    }
+  }
+
+  return terms;
+}
+
+/**
+ * @brief Bonus for own pawns on the king's file and its neighbours, one or two ranks ahead.
+ */
+int king_shelter(const Position &position, PieceColor us, int king) {
+  const uint64_t our_pawns = position.bitboards[bitboard_index(us, PIECE_PAWN)];
+  const int forward = us == WHITE ? 8 : -8;
+
+  int shelter = 0;
+  const uint64_t files = PAWN_MASKS.adjacent_files[square_file(king)] | FILE_A << square_file(king);
+  for (int step = 1; step <= 2; step++) {
+    const int rank_square = king + step * forward;
+    if (rank_square < 0 || rank_square >= 64) break;
+
+    const uint64_t rank = RANK_1 << (8 * square_rank(rank_square));
+    shelter += count_bits(our_pawns & files & rank) * (step == 1 ? SHELTER_CLOSE : SHELTER_FAR);
+  }
+
+  return shelter;
+}
+
+/**
+ * @brief Pawn structure for both sides, from the cache when possible. The king shelter is
+ * recomputed only when a king has moved since the entry was written.
+ */
+EvalTerms pawn_terms(const Position &position, PawnEntry &entry, bool found) {
+  if (!found) {
+    uint64_t white_passed, black_passed;
+    const EvalTerms white = pawn_structure(position, WHITE, white_passed);
+    const EvalTerms black = pawn_structure(position, BLACK, black_passed);
+
+    entry.key = position.pawn_key;
+    entry.mg = white.mg - black.mg;
+    entry.eg = white.eg - black.eg;
+    entry.passed[WHITE] = white_passed;
+    entry.passed[BLACK] = black_passed;
+    entry.shelter_king[WHITE] = entry.shelter_king[BLACK] = NO_SQUARE;
+  }
+
+  EvalTerms terms{entry.mg, entry.eg};
+  for (PieceColor us : {WHITE, BLACK}) {
+    const uint64_t king_bit = position.bitboards[bitboard_index(us, PIECE_KING)];
+    if (!king_bit) continue;
+
+    const Square king = static_cast<Square>(lsb_index(king_bit));
+    if (entry.shelter_king[us] != king) {
+      entry.shelter_king[us] = king;
+      entry.shelter[us] = king_shelter(position, us, king);
+    }
+    terms.mg += us == WHITE ? entry.shelter[us] : -entry.shelter[us];
+  }
+
+  return terms;
+}
+
+/**
+ * @brief Passed pawns gain in the endgame when the enemy king is far from their path and our own
+ * king is close. Uses the cached passed-pawn sets, so it costs nothing without passers.
+ */
+int passed_king_distance(const Position &position, const PawnEntry &entry, PieceColor us) {
+  const PieceColor them = opposite_color(us);
+  const uint64_t our_king = position.bitboards[bitboard_index(us, PIECE_KING)];
+  const uint64_t their_king = position.bitboards[bitboard_index(them, PIECE_KING)];
+  if (!our_king || !their_king) return 0;
+
+  const int forward = us == WHITE ? 8 : -8;
+  int bonus = 0;
+  uint64_t passed = entry.passed[us];
+  while (passed) {
+    const int square = pop_lsb(passed);
+    const int weight = relative_rank(us, square) - 3;
+    if (weight <= 0) continue;
+
+    const int stop = square + forward;
+    bonus += weight * PASSED_KING_DISTANCE
+             * (distance(lsb_index(their_king), stop) - distance(lsb_index(our_king), stop));
+  }
+
+  return bonus;
+}
+
+uint64_t piece_attacks(PieceType type, int square, uint64_t occupancy) {
+  switch (type) {
+    case PIECE_KNIGHT: return KNIGHT_ATTACKS[square];
+    case PIECE_BISHOP: return get_bishop_attacks(square, occupancy);
+    case PIECE_ROOK: return get_rook_attacks(square, occupancy);
+    case PIECE_QUEEN:
+      return get_bishop_attacks(square, occupancy) | get_rook_attacks(square, occupancy);
+    default: return 0;
+  }
+}
+
+/**
+ * @brief Mobility and king pressure of one side's pieces. Squares held by our own pieces or covered
+ * by enemy pawns do not count as mobility; the king term grows quadratically with the attack units
+ * on the enemy king zone and only applies once two pieces join in.
+ */
+EvalTerms piece_activity(const Position &position, PieceColor us) {
+  const PieceColor them = opposite_color(us);
+  const uint64_t occupancy = position.occupancy[ANY];
+  const uint64_t enemy_pawns = position.bitboards[bitboard_index(them, PIECE_PAWN)];
+  const uint64_t mobility_area = ~position.occupancy[us] & ~pawn_attacks(them, enemy_pawns);
+
+  const uint64_t enemy_king = position.bitboards[bitboard_index(them, PIECE_KING)];
+  const uint64_t king_zone = enemy_king ? KING_ATTACKS[lsb_index(enemy_king)] | enemy_king : 0;
+
+  EvalTerms terms;
+  int king_attackers = 0;
+  int attack_units = 0;
+
+  for (int type = PIECE_KNIGHT; type <= PIECE_QUEEN; type++) {
+    const PieceType piece = static_cast<PieceType>(type);
+    uint64_t pieces = position.bitboards[bitboard_index(us, piece)];
+    while (pieces) {
+      const uint64_t attacks = piece_attacks(piece, pop_lsb(pieces), occupancy);
+
+      const int mobility = count_bits(attacks & mobility_area);
+      terms.mg += MOBILITY_MG[type] * mobility;
+      terms.eg += MOBILITY_EG[type] * mobility;
+
+      const uint64_t zone_hits = attacks & king_zone;
+      if (zone_hits) {
+        king_attackers++;
+        attack_units += KING_ATTACK_UNITS[type] * count_bits(zone_hits);
+      }
+    }
+  }
+
+  if (king_attackers >= 2) {
+    terms.mg += std::min(attack_units * attack_units / 2, MAX_KING_DANGER);
+  }
+
+  return terms;
+}
+
+} // namespace
+
+int evaluate(const Position &position, PawnTable *pawn_table) {
+  assert(position.psq == position.compute_psq());
+
+  PawnEntry scratch;
+  bool found = false;
+  PawnEntry &entry = pawn_table ? pawn_table->probe(position.pawn_key, found) : scratch;
+  const EvalTerms pawns = pawn_terms(position, entry, found);
+
+  const EvalTerms white = piece_activity(position, WHITE);
+  const EvalTerms black = piece_activity(position, BLACK);
+  const int passers =
+      passed_king_distance(position, entry, WHITE) - passed_king_distance(position, entry, BLACK);
+
+  // White's point of view
+  const int mg = position.psq.mg + pawns.mg + white.mg - black.mg;
+  const int eg = position.psq.eg + pawns.eg + passers + white.eg - black.eg;
+  const int phase = std::min(position.psq.phase, MAX_PHASE);
+  const int score = (mg * phase + eg * (MAX_PHASE - phase)) / MAX_PHASE;
+
+  return position.to_move == WHITE ? score : -score;
+}
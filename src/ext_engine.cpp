@@ -1,13 +1,63 @@
 #include "ext_engine.hpp"
 
+#include "chess_types.hpp"
+#include "time_manager.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <climits>
+#include <cstdint>
 #include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 #include <sys/wait.h>
 #include <unistd.h>
 
+namespace {
+
+constexpr int UCI_TIMEOUT_MS = 1500;        // Engine start-up, until "uciok"
+constexpr int WRITE_TIMEOUT_MS = 1000;      // Engine not reading its input
+constexpr int READY_TIMEOUT_MS = 5000;      // Engine clearing its tables after ucinewgame
+constexpr int BESTMOVE_GRACE_MS = 15000;    // Beyond the search time, before giving up
+constexpr int PONDER_TIMEOUT_MS = 86400000; // A day: pondering lasts while the opponent thinks
+constexpr int STOP_GRACE_MS = 2000;         // Answer to "stop", cancelling waits on it
+constexpr int SIGNAL_POLL_MS = 20;          // How quickly stop and ponderhit reach the engine
+
+/**
+ * @brief Clock part of a go command, " wtime ... binc ..." with movestogo when there is one.
+ */
+std::string clock_arguments(const GameClock &clock, PieceColor side) {
+  std::string arguments;
+  arguments += " wtime " + std::to_string(clock.remaining_ms(WHITE));
+  arguments += " btime " + std::to_string(clock.remaining_ms(BLACK));
+  arguments += " winc " + std::to_string(clock.increment_ms(WHITE));
+  arguments += " binc " + std::to_string(clock.increment_ms(BLACK));
+  const int moves_to_go = clock.moves_to_go(side);
+  if (moves_to_go > 0) arguments += " movestogo " + std::to_string(moves_to_go);
+  return arguments;
+}
+
+/**
+ * @brief Search time plus BESTMOVE_GRACE_MS, saturated rather than overflowing int.
+ */
+int with_grace(int search_ms) {
+  return static_cast<int>(std::min<int64_t>(int64_t{search_ms} + BESTMOVE_GRACE_MS, INT_MAX));
+}
+
+int remaining_ms(std::chrono::steady_clock::time_point deadline) {
+  const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()
+  );
+  return static_cast<int>(std::max<int64_t>(0, remaining.count()));
+}
+
+} // namespace
+
 ExtEngine::ExtEngine(const std::string &command) : command(command), childPid(-1) {
   int in_fd[2];
   int out_fd[2];
@@ -41,26 +91,30 @@ ExtEngine::ExtEngine(const std::string &command) : command(command), childPid(-1
 
   close(in_fd[0]);
   close(out_fd[1]);
+  engineIn.reset(in_fd[1]);
+  engineOut.reset(out_fd[0]);
 
-  engineIn.reset(fdopen(in_fd[1], "w"));
-  engineOut.reset(fdopen(out_fd[0], "r"));
-
-  if (!engineIn || !engineOut) {
-    throw std::runtime_error("Failed to create file streams for UCI engine.");
+  if (fcntl(engineIn.get(), F_SETFL, fcntl(engineIn.get(), F_GETFL) | O_NONBLOCK) == -1
+      || fcntl(engineOut.get(), F_SETFL, fcntl(engineOut.get(), F_GETFL) | O_NONBLOCK) == -1) {
+    shutdown();
+    throw std::runtime_error("Failed to make UCI engine pipes non-blocking.");
   }
 
-  setvbuf(engineIn.get(), nullptr, _IOLBF, 0);
-  setvbuf(engineOut.get(), nullptr, _IOLBF, 0);
-
-  send_command("uci");
-  std::string response = read_until("uciok", 1500);
+  std::string response = request("uci", "uciok", UCI_TIMEOUT_MS, {});
   if (response.empty()) {
+    shutdown();
     throw std::runtime_error("UCI engine failed to respond with uciok within timeout.");
   }
 }
 
 ExtEngine::~ExtEngine() {
   send_command("quit");
+  shutdown();
+}
+
+void ExtEngine::shutdown() {
+  engineIn.reset();
+  engineOut.reset();
 
   if (childPid > 0) {
     kill(childPid, SIGTERM);
@@ -69,56 +123,228 @@ ExtEngine::~ExtEngine() {
   }
 }
 
-void ExtEngine::send_command(const std::string &command) {
-  fprintf(engineIn.get(), "%s\n", command.c_str());
-  fflush(engineIn.get());
+/**
+ * @brief Writes may only partially succeed on a non-blocking pipe; the rest waits for the engine
+ * to drain it, but no longer than WRITE_TIMEOUT_MS.
+ */
+bool ExtEngine::send_command(const std::string &command) {
+  if (!engineIn) return false;
+
+  const std::string line = command + "\n";
+  const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(WRITE_TIMEOUT_MS);
+  size_t written = 0;
+  while (written < line.size()) {
+    const ssize_t count = write(engineIn.get(), line.data() + written, line.size() - written);
+    if (count > 0) {
+      written += count;
+      continue;
+    }
+    if (count == -1 && errno == EINTR) continue;
+    if (count == -1 && errno != EAGAIN && errno != EWOULDBLOCK) return false;
+
+    pollfd poll_fd{engineIn.get(), POLLOUT, 0};
+    const int ready = poll(&poll_fd, 1, remaining_ms(deadline));
+    if (ready == 0 || (ready == -1 && errno != EINTR)) return false;
+  }
+
+  return true;
 }
 
-void ExtEngine::set_position(const std::string &fen) { send_command("position fen " + fen); }
+void ExtEngine::set_position(const std::string &fen) { set_position(fen, ""); }
+
+void ExtEngine::set_position(const std::string &root_fen, const std::string &moves) {
+  std::string position_command = "position ";
+  position_command += root_fen == INITIAL_POSITION_FEN ? "startpos" : "fen " + root_fen;
+  if (!moves.empty()) position_command += " moves " + moves;
+
+  send_command(position_command);
+}
+
+bool ExtEngine::new_game() {
+  send_command("ucinewgame");
+  return synchronize();
+}
+
+/**
+ * @brief isready / readyok round trip. Anything the engine still owed, such as the bestmove of a
+ * search that timed out, is read and dropped on the way.
+ */
+bool ExtEngine::synchronize() {
+  out_of_sync = request("isready", "readyok", READY_TIMEOUT_MS, {}).empty();
+  return !out_of_sync;
+}
+
+void ExtEngine::set_option(const std::string &name, const std::string &value) {
+  send_command("setoption name " + name + " value " + value);
+}
 
 std::string ExtEngine::get_best_move(int depth, int timeMs) {
   std::string goCommand = "go";
   if (depth > 0) goCommand += " depth " + std::to_string(depth);
   if (timeMs > 0) goCommand += " movetime " + std::to_string(timeMs);
 
-  send_command(goCommand);
-  std::string bestmove_line = read_until("bestmove", timeMs + 15000);
+  return go(goCommand, with_grace(timeMs), {});
+}
+
+std::string ExtEngine::get_best_move(
+    const GameClock &clock,
+    PieceColor side,
+    const std::atomic<bool> *stop
+) {
+  GoSignals signals;
+  signals.stop = stop;
+  const int timeout_ms = with_grace(clock.remaining_ms(side));
+  return go("go" + clock_arguments(clock, side), timeout_ms, signals);
+}
+
+/**
+ * @brief A ponder search has no deadline of its own, it lasts as long as the opponent thinks. Once
+ * the ponderhit is forwarded the engine is on its own clock and gets the usual timeout.
+ */
+std::string ExtEngine::ponder(
+    const GameClock &clock,
+    PieceColor side,
+    const std::atomic<bool> *stop,
+    const std::atomic<bool> *ponderhit
+) {
+  GoSignals signals;
+  signals.stop = stop;
+  signals.ponderhit = ponderhit;
+  signals.ponderhit_timeout_ms = with_grace(clock.remaining_ms(side));
+  return go("go ponder" + clock_arguments(clock, side), PONDER_TIMEOUT_MS, signals);
+}
+
+std::string ExtEngine::go(
+    const std::string &go_command,
+    int timeout_ms,
+    const GoSignals &signals
+) {
+  ponder_move.clear();
+  if (out_of_sync && !synchronize()) return "";
+
+  std::string bestmove_line = request(go_command, "bestmove", timeout_ms, signals);
   if (bestmove_line.empty()) return "";
 
   std::istringstream string_stream(bestmove_line);
-  std::string token;
-  string_stream >> token;
-  if (string_stream >> token) return token;
+  std::string token, best_move;
+  string_stream >> token >> best_move;
+  if (string_stream >> token && token == "ponder") string_stream >> ponder_move;
 
-  return "";
+  return best_move;
 }
 
-std::string ExtEngine::read_line() {
-  if (!engineOut) { return ""; }
+CommandLatency ExtEngine::get_latency(const std::string &command_name) const {
+  const auto found = latencies.find(command_name);
+  return found == latencies.end() ? CommandLatency{} : found->second;
+}
 
-  char buffer[1024];
-  if (fgets(buffer, sizeof(buffer), engineOut.get())) {
-    std::string line(buffer);
-    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
-      line.pop_back();
-    }
+/**
+ * @brief Send a command and wait for the line that answers it, recording the round trip under the
+ * command's first word.
+ */
+std::string ExtEngine::request(
+    const std::string &command,
+    const std::string &expected,
+    int timeout_ms,
+    const GoSignals &signals
+) {
+  const Clock::time_point sent = Clock::now();
+  if (!send_command(command)) return "";
 
-    return line;
+  std::string response = read_until(expected, timeout_ms, signals);
+  if (response.empty()) {
+    out_of_sync = true;
+    return "";
   }
 
-  return "";
+  const std::chrono::duration<double, std::milli> elapsed = Clock::now() - sent;
+  CommandLatency &latency = latencies[command.substr(0, command.find(' '))];
+  latency.count++;
+  latency.last_ms = elapsed.count();
+  latency.total_ms += elapsed.count();
+  latency.max_ms = std::max(latency.max_ms, elapsed.count());
+  return response;
+}
+
+/**
+ * @brief Next complete line of engine output, waiting in poll() until the deadline at most.
+ * False on timeout and once the engine has closed its output.
+ */
+bool ExtEngine::read_line(std::string_view &line, Clock::time_point deadline) {
+  while (true) {
+    if (output.next_line(line)) return true;
+    if (output_closed || !engineOut) return false;
+
+    const ssize_t count = output.fill(engineOut.get());
+    if (count > 0) continue;
+    if (count == 0) {
+      output_closed = true;
+      return false;
+    }
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+
+    pollfd poll_fd{engineOut.get(), POLLIN, 0};
+    const int ready = poll(&poll_fd, 1, remaining_ms(deadline));
+    if (ready == 0 || (ready == -1 && errno != EINTR)) return false;
+  }
 }
 
-std::string ExtEngine::read_until(const std::string &expected_response, int timeout_ms) {
-  auto start_time = std::chrono::steady_clock::now();
-  auto timeout_duration = std::chrono::milliseconds(timeout_ms);
+/**
+ * @brief Wait for a line starting with expected_response, passing other output on the way to
+ * handle_line. With signals the wait wakes up every SIGNAL_POLL_MS to check them and forwards each
+ * to the engine once as "stop" or "ponderhit", so all engine I/O stays on the calling thread. The
+ * deadline and signals are checked after every line as well, so a chatty engine cannot outrun them.
+ * Once stopped, the engine has STOP_GRACE_MS to answer, however long the search was allowed.
+ */
+std::string ExtEngine::read_until(
+    const std::string &expected_response,
+    int timeout_ms,
+    const GoSignals &signals
+) {
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+  bool stop_sent = false;
+  bool ponderhit_sent = false;
 
+  std::string_view line;
   while (true) {
-    std::string line = read_line();
+    const bool stop_pending = signals.stop && !stop_sent;
+    const bool ponderhit_pending = signals.ponderhit && !ponderhit_sent && !stop_sent;
+
+    Clock::time_point wake_up = deadline;
+    if (stop_pending || ponderhit_pending) {
+      wake_up = std::min(deadline, Clock::now() + std::chrono::milliseconds(SIGNAL_POLL_MS));
+    }
 
-    if (!line.empty() && line.find(expected_response) != std::string::npos) return line;
+    if (read_line(line, wake_up)) {
+      if (line.substr(0, expected_response.size()) == expected_response) return std::string(line);
+      handle_line(line);
+    } else if (output_closed || Clock::now() < wake_up) {
+      return ""; // Only a poll timeout is worth waiting on, not a closed or broken pipe
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (now >= deadline) return "";
+
+    if (stop_pending && signals.stop->load(std::memory_order_relaxed)) {
+      send_command("stop");
+      stop_sent = true;
+      deadline = std::min(deadline, now + std::chrono::milliseconds(STOP_GRACE_MS));
+    } else if (ponderhit_pending && signals.ponderhit->load(std::memory_order_relaxed)) {
+      send_command("ponderhit");
+      ponderhit_sent = true;
+      deadline = now + std::chrono::milliseconds(signals.ponderhit_timeout_ms);
+    }
+  }
+}
 
-    auto current_time = std::chrono::steady_clock::now();
-    if (current_time - start_time > timeout_duration) return "";
+/**
+ * @brief Output that answers nothing: search statistics, and the options announced after "uci".
+ */
+void ExtEngine::handle_line(std::string_view line) {
+  if (line.substr(0, 5) == "info ") {
+    if (info_handler) info_handler(line);
+  } else if (line.substr(0, 19) == "option name Ponder ") {
+    can_ponder = true;
   }
 }
@@ -2,24 +2,44 @@
 
 #include "chess_types.hpp"
 #include "ext_engine.hpp"
+#include "notation.hpp"
+#include "perft.hpp"
 #include "position.hpp"
+#include "search.hpp"
+#include "thread_pool.hpp"
+#include "time_manager.hpp"
+#include "uci_info.hpp"
 
 #include <algorithm>
 #include <cstdint>
-#include <stdexcept>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
 
 void GameState::new_game(GameMode mode, PieceColor player_color) {
-  if (mode == PLAYER_VS_ENGINE && !has_engine) {
-    throw std::runtime_error("GameState::new_game() - No engine available!");
-  }
-
-  pos.set_fen(INITIAL_POSITION_FEN);
+  set_fen(INITIAL_POSITION_FEN);
+  search.clear();
+  clock.reset(time_control);
   this->player_color = player_color;
   legal_cache_valid = false;
   ongoing_game = true;
   current_mode = mode;
 
-  if (mode == PLAYER_VS_ENGINE && player_color == BLACK) make_engine_move();
+  if (mode == PLAYER_VS_ENGINE && player_color == BLACK) start_engine_move();
+}
+
+/**
+ * @brief Start over from a position. An external engine is told it is a new game before its next
+ * search.
+ */
+void GameState::set_fen(const std::string &fen) {
+  cancel_engine_move();
+  pos.set_fen(fen);
+  root_fen = fen;
+  uci_moves.clear();
+  engine_new_game = true;
+  legal_cache_valid = false;
 }
 
 MoveList GameState::get_legal_moves() const {
@@ -45,7 +65,13 @@ MoveList GameState::get_legal_moves_from(Square square) const {
   return filtered_moves;
 };
 
+/**
+ * @brief Moves past MAX_GAME_PLIES are refused, so searches keep their MAX_SEARCH_PLY plies of room
+ * in the position's undo stack.
+ */
 bool GameState::validate_move(const Move &move) const {
+  if (pos.get_history_length() >= MAX_GAME_PLIES) return false;
+
   if (!legal_cache_valid) {
     legal_moves = generator.generate_legal_moves(pos);
     legal_cache_valid = true;
@@ -63,84 +89,187 @@ MoveList GameState::get_cached_moves() {
   return legal_moves;
 };
 
+/**
+ * @brief While the engine ponders, the expected reply hands the ponder search over as the engine's
+ * move and any other move cancels it.
+ */
 bool GameState::make_move(const Move &move) {
-  if (!validate_move(move)) return false;
+  if (engine_thinking || !validate_move(move)) return false;
+
+  const bool ponder_hit = engine_pondering && move == ponder_move;
+  if (engine_pondering && !ponder_hit) {
+    cancel_engine_move();
+    ponder_misses++;
+  }
 
   legal_cache_valid = false;
+  clock.press(pos.to_move);
   pos.make_move(move);
+
+  if (!uci_moves.empty()) uci_moves += ' ';
+  uci_moves += move_to_uci(move);
+
+  if (ponder_hit) {
+    ponder_hits++;
+    engine_pondering = false;
+    engine_thinking = true;
+    engine_ponderhit.store(true, std::memory_order_relaxed);
+  }
   return true;
 }
 
 void GameState::undo_move() {
+  if (engine_thinking) return;
+  cancel_engine_move(); // Pondering on a reply to the move being taken back
+
   legal_cache_valid = false;
+  clock.restart_turn();
   pos.undo_move();
-}
 
-uint64_t GameState::perft(int depth) {
-  if (depth == 0) return 1;
+  const size_t last_move = uci_moves.rfind(' ');
+  uci_moves.erase(last_move == std::string::npos ? 0 : last_move);
+}
 
-  MoveList moves = get_legal_moves();
-  if (depth == 1) return moves.count;
+uint64_t GameState::perft(int depth, const PerftOptions &options) const {
+  return Perft(options).run(pos, depth).nodes;
+}
 
-  uint64_t nodes = 0;
-  for (int i = 0; i < moves.count; i++) {
-    make_move(moves[i]);
-    nodes += perft(depth - 1);
-    undo_move();
+bool GameState::start_engine_move() {
+  if (engine_thinking || engine_pondering || get_legal_moves().empty()) return false;
+  if (pos.get_history_length() >= MAX_GAME_PLIES) return false;
+
+  if (!engine_thread) engine_thread = std::make_unique<ThreadPool>(1);
+  const uint64_t generation = ++engine_generation;
+  engine_stop.store(false, std::memory_order_relaxed);
+  engine_thinking = true;
+  engine_info.reset();
+
+  if (engine) {
+    const bool start_session = std::exchange(engine_new_game, false);
+    engine_thread->submit([this, generation, start_session, ponder = pondering_enabled,
+                           root = root_fen, moves = uci_moves, position = pos,
+                           clocks = clock]() mutable {
+      if (start_session) {
+        if (ponder && engine->supports_ponder()) engine->set_option("Ponder", "true");
+        engine->new_game();
+      }
+      engine->set_info_handler([this, &position](std::string_view line) {
+        UciInfo info;
+        if (parse_uci_info(line, position, generator, info)) engine_infos.push(info);
+      });
+
+      engine->set_position(root, moves);
+      const std::string uci_move = engine->get_best_move(clocks, position.to_move, &engine_stop);
+      engine->set_info_handler(nullptr);
+      engine_replies.push({generation, std::nullopt, uci_move, engine->get_ponder_move()});
+    });
+    return true;
   }
 
-  return nodes;
+  const TimeBudget budget = allocate_time(clock, pos.to_move);
+  SearchLimits limits;
+  limits.time_ms = budget.hard_ms;
+  limits.soft_time_ms = budget.soft_ms;
+  limits.stop = &engine_stop;
+
+  // There are legal moves, so even a search stopped before its first iteration has a best move:
+  // the first legal one
+  engine_thread->submit([this, generation, position = pos, limits]() {
+    const SearchResult result = search.run(position, limits);
+    engine_replies.push({generation, result.best_move, "", ""});
+  });
+  return true;
 }
 
-bool GameState::make_engine_move() {
-  if (!engine) return false;
+/**
+ * @brief Have the external engine search the position after expected_reply on the player's time.
+ * Only engines that announced the Ponder option are asked, and only in an ongoing game against
+ * the player.
+ */
+void GameState::start_pondering(const std::string &expected_reply) {
+  if (!pondering_enabled || !engine || !engine->supports_ponder()) return;
+  if (current_mode != PLAYER_VS_ENGINE || !is_game_ongoing()) return;
+
+  Move reply;
+  if (!uci_to_move(expected_reply, get_cached_moves(), reply)) return;
+
+  const uint64_t generation = ++engine_generation;
+  engine_stop.store(false, std::memory_order_relaxed);
+  engine_ponderhit.store(false, std::memory_order_relaxed);
+  engine_pondering = true;
+  ponder_move = reply;
+  engine_info.reset();
+
+  Position position = pos;
+  position.make_move(reply);
+  engine_thread->submit([this, generation, root = root_fen,
+                         moves = uci_moves + ' ' + expected_reply, position,
+                         clocks = clock]() mutable {
+    engine->set_info_handler([this, &position](std::string_view line) {
+      UciInfo info;
+      if (parse_uci_info(line, position, generator, info)) engine_infos.push(info);
+    });
+
+    engine->set_position(root, moves);
+    const std::string uci_move =
+        engine->ponder(clocks, position.to_move, &engine_stop, &engine_ponderhit);
+    engine->set_info_handler(nullptr);
+    engine_replies.push({generation, std::nullopt, uci_move, engine->get_ponder_move()});
+  });
+}
 
-  std::string fen = get_fen();
-  engine->set_position(fen);
+bool GameState::poll_engine_move() {
+  UciInfo info;
+  while (engine_infos.try_pop(info)) {
+    if (info.multipv == 1) engine_info = info;
+  }
 
-  std::string uci_move = engine->get_best_move(15, 2000);
+  EngineReply reply;
+  while (engine_replies.try_pop(reply)) {
+    if (reply.generation != engine_generation) continue;
 
-  if (uci_move.empty()) return false;
+    // A ponder search that ended before the player moved has nothing to play
+    if (engine_pondering) {
+      engine_pondering = false;
+      continue;
+    }
 
-  if (uci_move.length() < 4) return false;
+    engine_thinking = false;
+    if (!engine) return reply.move && make_move(*reply.move);
+    if (!make_uci_move(reply.uci_move)) return false;
 
-  int from_file = uci_move[0] - 'a';
-  int from_rank = uci_move[1] - '1';
-  int to_file = uci_move[2] - 'a';
-  int to_rank = uci_move[3] - '1';
+    start_pondering(reply.ponder_move);
+    return true;
+  }
 
-  Square from = static_cast<Square>(from_rank * 8 + from_file);
-  Square to = static_cast<Square>(to_rank * 8 + to_file);
+  return false;
+}
 
-  MoveList legal_moves = get_legal_moves_from(from);
+void GameState::cancel_engine_move() {
+  if (!engine_thinking && !engine_pondering) return;
 
-  Move *valid_move = nullptr;
-  for (int i = 0; i < legal_moves.count; i++) {
-    if (legal_moves[i].to == to) {
-      if (uci_move.length() == 5) {
-        char promotion_char = uci_move[4];
-        PieceType expected_promotion = PIECE_NONE;
-        switch (promotion_char) {
-          case 'q': expected_promotion = PIECE_QUEEN; break;
-          case 'r': expected_promotion = PIECE_ROOK; break;
-          case 'b': expected_promotion = PIECE_BISHOP; break;
-          case 'n': expected_promotion = PIECE_KNIGHT; break;
-        }
-
-        if (legal_moves[i].is_promotion() && legal_moves[i].promotion_piece == expected_promotion) {
-          valid_move = &legal_moves[i];
-          break;
-        }
-      } else {
-        valid_move = &legal_moves[i];
-        break;
-      }
-    }
-  }
+  engine_generation++;
+  stop_engine();
+  engine_thread->wait_idle();
+  engine_replies.clear();
+  engine_infos.clear();
+  engine_thinking = false;
+  engine_pondering = false;
+}
 
-  if (valid_move) { return make_move(*valid_move); }
+/**
+ * @brief After a ponder hit the engine is already thinking, so only its reply is waited for.
+ */
+bool GameState::make_engine_move() {
+  if (!engine_thinking && !start_engine_move()) return false;
 
-  return false;
+  engine_thread->wait_idle();
+  return poll_engine_move();
+}
+
+bool GameState::make_uci_move(const std::string &uci_move) {
+  Move move;
+  return uci_to_move(uci_move, get_cached_moves(), move) && make_move(move);
 }
 
 GameResult GameState::get_game_result() const {
@@ -153,22 +282,11 @@ GameResult GameState::get_game_result() const {
 
   if (pos.halfmove_clock >= 100) return DRAW_FIFTY_MOVE_RULE;
 
-  int white_pieces = 0, black_pieces = 0;
-  for (int square = 0; square < 64; square++) {
-    Piece piece = pos.get_piece_at(static_cast<Square>(square));
-    if (piece.type == PIECE_NONE) continue;
-
-    if (piece.color == WHITE) {
-      white_pieces++;
-    } else {
-      black_pieces++;
-    }
-  }
+  if (pos.count_repetitions() >= 2) return DRAW_REPETITION;
 
-  if (white_pieces == 1 && black_pieces == 1) return DRAW_INSUFFICIENT_MATERIAL;
+  if (pos.has_insufficient_material()) return DRAW_INSUFFICIENT_MATERIAL;
 
-  // TODO: More insufficient material cases (e.g., King and Bishop vs King, King and Knight vs King,
-  // etc.)
+  if (pos.get_history_length() >= MAX_GAME_PLIES) return DRAW_OTHER;
 
   return GAME_ONGOING;
 }
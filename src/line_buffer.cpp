@@ -0,0 +1,87 @@
+#include "line_buffer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t RING_MASK = LineBuffer::CAPACITY - 1;
+
+} // namespace
+
+LineBuffer::LineBuffer()
+    : ring(std::make_unique<char[]>(CAPACITY)), wrapped(std::make_unique<char[]>(CAPACITY)) {}
+
+ssize_t LineBuffer::fill(int fd) {
+  const size_t free = CAPACITY - size();
+  if (free == 0) {
+    errno = ENOBUFS;
+    return -1;
+  }
+
+  // One read into the contiguous free space; the part before the ring's start is picked up by the
+  // next call
+  const size_t start = tail & RING_MASK;
+  const ssize_t count = read(fd, ring.get() + start, std::min(free, CAPACITY - start));
+  if (count > 0) tail += count;
+  return count;
+}
+
+size_t LineBuffer::append(const char *bytes, size_t count) {
+  count = std::min(count, CAPACITY - size());
+  const size_t start = tail & RING_MASK;
+  const size_t first = std::min(count, CAPACITY - start);
+  std::memcpy(ring.get() + start, bytes, first);
+  std::memcpy(ring.get(), bytes + first, count - first);
+  tail += count;
+  return count;
+}
+
+bool LineBuffer::next_line(std::string_view &line) {
+  while (scanned < tail) {
+    const uint64_t position = scanned++;
+    if (ring[position & RING_MASK] != '\n') continue;
+
+    if (discarding) {
+      discarding = false;
+      head = scanned;
+      continue;
+    }
+    line = take(position, scanned);
+    return true;
+  }
+
+  if (discarding) {
+    head = tail;
+  } else if (size() == CAPACITY) {
+    line = take(tail, tail);
+    discarding = true;
+    return true;
+  }
+  return false;
+}
+
+void LineBuffer::clear() {
+  head = tail = scanned = 0;
+  discarding = false;
+}
+
+/**
+ * @brief View of [head, end) without a trailing "\r", then consume up to next_head. Only a line
+ * that wraps around the end of the ring is copied.
+ */
+std::string_view LineBuffer::take(uint64_t end, uint64_t next_head) {
+  if (end > head && ring[(end - 1) & RING_MASK] == '\r') end--;
+
+  const size_t start = head & RING_MASK;
+  const size_t length = static_cast<size_t>(end - head);
+  head = next_head;
+  if (start + length <= CAPACITY) return std::string_view(ring.get() + start, length);
+
+  const size_t first = CAPACITY - start;
+  std::memcpy(wrapped.get(), ring.get() + start, first);
+  std::memcpy(wrapped.get() + first, ring.get(), length - first);
+  return std::string_view(wrapped.get(), length);
+}
@@ -2,19 +2,41 @@
 #include "game_logic.hpp"
 #include "menu.hpp"
 #include "size_warning.hpp"
+#include "time_manager.hpp"
 #include "win_handler.hpp"
 
+#include <cstdio>
+#include <exception>
+#include <memory>
 #include <ncurses.h>
+#include <string>
 #include <sys/types.h>
 
 struct Args {
   std::string engine_cmd = "";
+  std::string nnue_file = "";
+  TimeControl time_control{};
+  bool ponder = true;
 };
 
 Args parse_args(int argc, char *argv[]);
 
 int main(int argc, char *argv[]) {
   Args args = parse_args(argc, argv);
+
+  // Loading the network can fail, report that before curses takes over the terminal
+  SearchOptions search_options;
+  search_options.nnue_file = args.nnue_file;
+  std::unique_ptr<GameState> game_state;
+  try {
+    game_state = std::make_unique<GameState>(args.engine_cmd, INITIAL_POSITION_FEN, search_options);
+  } catch (const std::exception &e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  game_state->set_time_control(args.time_control);
+  game_state->set_pondering(args.ponder);
+
   setlocale(LC_ALL, "");
   initscr();   // Initialize ncurses
   noecho();    // Don't echo input characters
@@ -31,9 +53,7 @@ int main(int argc, char *argv[]) {
     init_pair(static_cast<int>(SquareColor::LEGAL_MOVE), COLOR_GREEN, COLOR_YELLOW);
   }
 
-  GameState game_state = GameState(args.engine_cmd);
-
-  TuiState tui_state(19, 46, game_state);
+  TuiState tui_state(19, 46, *game_state);
   tui_state.menu_win_name = "menu";
   tui_state.board_win_name = "board";
 
@@ -58,6 +78,20 @@ Args parse_args(int argc, char *argv[]) {
       args.engine_cmd = argv[i];
       continue;
     }
+    if (arg == "--nnue" && i + 1 < argc) {
+      i++;
+      args.nnue_file = argv[i];
+      continue;
+    }
+    if (arg == "--time" && i + 1 < argc) {
+      i++;
+      parse_time_control(argv[i], args.time_control);
+      continue;
+    }
+    if (arg == "--no-ponder") {
+      args.ponder = false;
+      continue;
+    }
   }
 
   return args;
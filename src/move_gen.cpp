@@ -1,25 +1,37 @@
 #include "move_gen.hpp"
 
+#include "attacks.hpp"
 #include "chess_types.hpp"
+#include "evaluate.hpp"
 
+#include <algorithm>
 #include <cstdint>
 
+/**
+ * @brief A pinned piece may only move along the line through its king.
+ */
+static bool pin_allows(const CheckInfo &info, Square from, Square to) {
+  if (!(info.pinned & square_to_bit(from))) return true;
+  return line_bb(info.king_square, from) & square_to_bit(to);
+}
+
 MoveList MoveGenerator::generate_pseudo_legal_moves(const Position &position) const {
   MoveList move_list;
   Move *moves = move_list.moves;
   Move *start = moves;
+  const CheckInfo info{};
 
   if (position.to_move == WHITE) {
-    moves += generate_pawn_moves<WHITE>(position, moves);
+    moves += generate_pawn_moves<WHITE>(position, info, moves);
   } else {
-    moves += generate_pawn_moves<BLACK>(position, moves);
+    moves += generate_pawn_moves<BLACK>(position, info, moves);
   }
 
-  moves += generate_piece_moves<PIECE_KNIGHT>(position, moves);
-  moves += generate_piece_moves<PIECE_BISHOP>(position, moves);
-  moves += generate_piece_moves<PIECE_ROOK>(position, moves);
-  moves += generate_piece_moves<PIECE_QUEEN>(position, moves);
-  moves += generate_piece_moves<PIECE_KING>(position, moves);
+  moves += generate_piece_moves<PIECE_KNIGHT>(position, info, moves);
+  moves += generate_piece_moves<PIECE_BISHOP>(position, info, moves);
+  moves += generate_piece_moves<PIECE_ROOK>(position, info, moves);
+  moves += generate_piece_moves<PIECE_QUEEN>(position, info, moves);
+  moves += generate_piece_moves<PIECE_KING>(position, info, moves);
   moves += generate_castling_moves(position, moves);
 
   move_list.count = moves - start;
@@ -27,18 +39,169 @@ MoveList MoveGenerator::generate_pseudo_legal_moves(const Position &position) co
 }
 
 MoveList MoveGenerator::generate_legal_moves(const Position &position) const {
-  MoveList pseudo_legal = generate_pseudo_legal_moves(position);
+  MoveList move_list;
+  generate_legal_moves(position, move_list);
+  return move_list;
+}
+
+/**
+ * @brief Fill a caller-owned list, so searches can keep one list per ply instead of copying.
+ */
+void MoveGenerator::generate_legal_moves(const Position &position, MoveList &move_list) const {
+  generate_legal<GEN_ALL>(position, move_list);
+}
+
+void MoveGenerator::generate_legal_captures(const Position &position, MoveList &move_list) const {
+  generate_legal<GEN_CAPTURES>(position, move_list);
+}
+
+void MoveGenerator::generate_legal_quiets(const Position &position, MoveList &move_list) const {
+  generate_legal<GEN_QUIETS>(position, move_list);
+}
+
+template<GenType Gen>
+void MoveGenerator::generate_legal(const Position &position, MoveList &move_list) const {
+  Move *moves = move_list.moves;
+  Move *start = moves;
+  const CheckInfo info = compute_check_info(position);
+
+  // Only the king can answer a double check
+  if (count_bits(info.checkers) < 2) {
+    if (position.to_move == WHITE) {
+      moves += generate_pawn_moves<WHITE, Gen>(position, info, moves);
+    } else {
+      moves += generate_pawn_moves<BLACK, Gen>(position, info, moves);
+    }
 
-  MoveList legal_moves;
-  for (int i = 0; i < pseudo_legal.count; i++) {
-    if (is_legal_move(position, pseudo_legal[i])) { legal_moves.add_move(pseudo_legal[i]); }
+    moves += generate_piece_moves<PIECE_KNIGHT, Gen>(position, info, moves);
+    moves += generate_piece_moves<PIECE_BISHOP, Gen>(position, info, moves);
+    moves += generate_piece_moves<PIECE_ROOK, Gen>(position, info, moves);
+    moves += generate_piece_moves<PIECE_QUEEN, Gen>(position, info, moves);
   }
 
-  return legal_moves;
+  moves += generate_piece_moves<PIECE_KING, Gen>(position, info, moves);
+  if (Gen != GEN_CAPTURES && !info.checkers) moves += generate_castling_moves(position, moves);
+
+  move_list.count = moves - start;
 }
 
-template<PieceColor Us>
-int MoveGenerator::generate_pawn_moves(const Position &position, Move *moves) const {
+/**
+ * @brief Number of legal moves, counted from target bitboards without building a MoveList.
+ * Promotions count once per promotion piece.
+ */
+int MoveGenerator::count_legal_moves(const Position &position) const {
+  const CheckInfo info = compute_check_info(position);
+  const uint64_t our_occupancy = position.occupancy[position.to_move];
+
+  int count = count_bits(KING_ATTACKS[info.king_square] & ~our_occupancy & ~info.king_danger);
+  if (count_bits(info.checkers) > 1) return count;
+
+  if (position.to_move == WHITE) {
+    count += count_pawn_moves<WHITE>(position, info);
+  } else {
+    count += count_pawn_moves<BLACK>(position, info);
+  }
+
+  count += count_piece_moves<PIECE_KNIGHT>(position, info);
+  count += count_piece_moves<PIECE_BISHOP>(position, info);
+  count += count_piece_moves<PIECE_ROOK>(position, info);
+  count += count_piece_moves<PIECE_QUEEN>(position, info);
+  if (!info.checkers) count += count_bits(castling_destinations(position));
+
+  return count;
+}
+
+/**
+ * @brief Whether an arbitrary move, such as a hash or killer move from another position, is legal
+ * here, including its type flags. Checks the attack tables directly instead of generating moves.
+ */
+bool MoveGenerator::is_legal(const Position &position, const Move &move) const {
+  const PieceColor us = position.to_move;
+  const PieceColor them = opposite_color(us);
+  if (move.from >= NO_SQUARE || move.to >= NO_SQUARE || move.from == move.to) return false;
+
+  const uint64_t from_bit = square_to_bit(move.from);
+  const uint64_t to_bit = square_to_bit(move.to);
+  if (!(position.occupancy[us] & from_bit) || (position.occupancy[us] & to_bit)) return false;
+
+  const PieceType type = decode_type(position.lookup_table[move.from]);
+  const uint64_t occupancy = position.occupancy[ANY];
+  const bool takes_piece = position.occupancy[them] & to_bit;
+  uint64_t captured = takes_piece ? to_bit : 0;
+
+  if (move.is_castling()) {
+    return type == PIECE_KING && move.type == CASTLING && move.promotion_piece == PIECE_NONE
+           && (castling_destinations(position) & to_bit);
+  }
+
+  if (move.is_en_passant()) {
+    if (type != PIECE_PAWN || move.type != EN_PASSANT || move.to != position.en_passant_square
+        || !(PAWN_ATTACKS[us][move.from] & to_bit))
+      return false;
+    captured = square_to_bit(indexes_to_square(square_rank(move.from), square_file(move.to)));
+  } else if (move.is_capture() != takes_piece) {
+    return false;
+  }
+
+  const uint64_t last_rank = us == WHITE ? RANK_8 : RANK_1;
+  const bool promotes = type == PIECE_PAWN && (to_bit & last_rank);
+  if (promotes != move.is_promotion()) return false;
+  if (promotes
+      && (move.promotion_piece < PIECE_KNIGHT || move.promotion_piece > PIECE_QUEEN))
+    return false;
+  if (!promotes && move.promotion_piece != PIECE_NONE) return false;
+
+  uint64_t reach = 0;
+  switch (type) {
+    case PIECE_PAWN: {
+      const int forward = us == WHITE ? NORTH : SOUTH;
+      const uint64_t start_rank = us == WHITE ? RANK_2 : RANK_7;
+      const uint64_t single = square_to_bit(static_cast<Square>(move.from + forward));
+
+      if (move.is_capture()) {
+        reach = PAWN_ATTACKS[us][move.from];
+      } else if (!(single & occupancy)) {
+        reach = single;
+        if (from_bit & start_rank) {
+          reach |= square_to_bit(static_cast<Square>(move.from + 2 * forward)) & ~occupancy;
+        }
+      }
+      break;
+    }
+    case PIECE_KNIGHT: reach = KNIGHT_ATTACKS[move.from]; break;
+    case PIECE_BISHOP: reach = get_bishop_attacks(move.from, occupancy); break;
+    case PIECE_ROOK: reach = get_rook_attacks(move.from, occupancy); break;
+    case PIECE_QUEEN:
+      reach = get_bishop_attacks(move.from, occupancy) | get_rook_attacks(move.from, occupancy);
+      break;
+    case PIECE_KING: reach = KING_ATTACKS[move.from]; break;
+    default: return false;
+  }
+  if (!(reach & to_bit)) return false;
+
+  // Replay the occupancy change and look for any attacker left on our king
+  const Square king = type == PIECE_KING ? move.to : find_king(position, us);
+  const uint64_t after = ((occupancy ^ from_bit) & ~captured) | to_bit;
+  const uint64_t enemies = ~captured;
+  const uint64_t queens = position.bitboards[bitboard_index(them, PIECE_QUEEN)];
+  const uint64_t straight = position.bitboards[bitboard_index(them, PIECE_ROOK)] | queens;
+  const uint64_t diagonal = position.bitboards[bitboard_index(them, PIECE_BISHOP)] | queens;
+
+  const uint64_t attackers =
+      (PAWN_ATTACKS[us][king] & position.bitboards[bitboard_index(them, PIECE_PAWN)])
+      | (KNIGHT_ATTACKS[king] & position.bitboards[bitboard_index(them, PIECE_KNIGHT)])
+      | (KING_ATTACKS[king] & position.bitboards[bitboard_index(them, PIECE_KING)])
+      | (get_bishop_attacks(king, after) & diagonal) | (get_rook_attacks(king, after) & straight);
+
+  return (attackers & enemies) == 0;
+}
+
+template<PieceColor Us, GenType Gen>
+int MoveGenerator::generate_pawn_moves(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const {
   Move *start = moves;
   constexpr PieceColor Them = (Us == WHITE) ? BLACK : WHITE;
   constexpr int Forward = (Us == WHITE) ? NORTH : SOUTH;
@@ -46,20 +209,25 @@ int MoveGenerator::generate_pawn_moves(const Position &position, Move *moves) co
   constexpr uint64_t PromotionRank = (Us == WHITE) ? RANK_8 : RANK_1;
 
   const uint64_t our_pawns = position.bitboards[bitboard_index(Us, PIECE_PAWN)];
-  const uint64_t enemy_pieces = position.occupancy[Them];
+  const uint64_t enemy_pieces = position.occupancy[Them] & info.check_mask;
   const uint64_t empty_squares = ~position.occupancy[ANY];
+  const uint64_t push_targets = empty_squares & info.check_mask;
 
   // Single pushes
   uint64_t single_pushes;
   if constexpr (Us == WHITE) {
-    single_pushes = (our_pawns << NORTH) & empty_squares;
+    single_pushes = (our_pawns << NORTH) & push_targets;
   } else {
-    single_pushes = (our_pawns >> (-SOUTH)) & empty_squares;
+    single_pushes = (our_pawns >> (-SOUTH)) & push_targets;
   }
 
+  if constexpr (Gen == GEN_CAPTURES) single_pushes &= PromotionRank;
+  if constexpr (Gen == GEN_QUIETS) single_pushes &= ~PromotionRank;
+
   while (single_pushes) {
     const Square to = static_cast<Square>(pop_lsb(single_pushes));
     const Square from = static_cast<Square>(to - Forward);
+    if (!pin_allows(info, from, to)) continue;
 
     if (square_to_bit(to) & PromotionRank) {
       *moves++ = {from, to, PROMOTION, PIECE_QUEEN};
@@ -72,50 +240,59 @@ int MoveGenerator::generate_pawn_moves(const Position &position, Move *moves) co
   }
 
   // Double pushes
-  uint64_t double_pushes;
-  if constexpr (Us == WHITE) {
-    const uint64_t single_push_from_start = ((our_pawns & StartingRank) << NORTH) & empty_squares;
-    double_pushes = (single_push_from_start << NORTH) & empty_squares;
-  } else {
-    const uint64_t single_push_from_start =
-        ((our_pawns & StartingRank) >> (-SOUTH)) & empty_squares;
-    double_pushes = (single_push_from_start >> (-SOUTH)) & empty_squares;
-  }
+  if constexpr (Gen != GEN_CAPTURES) {
+    uint64_t double_pushes;
+    if constexpr (Us == WHITE) {
+      const uint64_t single_push_from_start =
+          ((our_pawns & StartingRank) << NORTH) & empty_squares;
+      double_pushes = (single_push_from_start << NORTH) & push_targets;
+    } else {
+      const uint64_t single_push_from_start =
+          ((our_pawns & StartingRank) >> (-SOUTH)) & empty_squares;
+      double_pushes = (single_push_from_start >> (-SOUTH)) & push_targets;
+    }
 
-  while (double_pushes) {
-    const Square to = static_cast<Square>(pop_lsb(double_pushes));
-    const Square from = static_cast<Square>(to - 2 * Forward);
-    *moves++ = {from, to};
+    while (double_pushes) {
+      const Square to = static_cast<Square>(pop_lsb(double_pushes));
+      const Square from = static_cast<Square>(to - 2 * Forward);
+      if (!pin_allows(info, from, to)) continue;
+      *moves++ = {from, to};
+    }
   }
 
-  // Regular captures
-  uint64_t pawns_copy = our_pawns;
-  while (pawns_copy) {
-    const Square from = static_cast<Square>(pop_lsb(pawns_copy));
-    uint64_t attacks = PAWN_ATTACKS[Us][from] & enemy_pieces;
-
-    while (attacks) {
-      const Square to = static_cast<Square>(pop_lsb(attacks));
-
-      if (square_to_bit(to) & PromotionRank) {
-        *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_QUEEN};
-        *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_ROOK};
-        *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_BISHOP};
-        *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_KNIGHT};
-      } else {
-        *moves++ = {from, to, CAPTURE};
+  // Regular and en passant captures
+  if constexpr (Gen != GEN_QUIETS) {
+    uint64_t pawns_copy = our_pawns;
+    while (pawns_copy) {
+      const Square from = static_cast<Square>(pop_lsb(pawns_copy));
+      uint64_t attacks = PAWN_ATTACKS[Us][from] & enemy_pieces;
+      if (info.pinned & square_to_bit(from)) attacks &= line_bb(info.king_square, from);
+
+      while (attacks) {
+        const Square to = static_cast<Square>(pop_lsb(attacks));
+
+        if (square_to_bit(to) & PromotionRank) {
+          *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_QUEEN};
+          *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_ROOK};
+          *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_BISHOP};
+          *moves++ = {from, to, static_cast<MoveType>(CAPTURE | PROMOTION), PIECE_KNIGHT};
+        } else {
+          *moves++ = {from, to, CAPTURE};
+        }
       }
     }
-  }
 
-  // En passant captures
-  if (position.en_passant_square.has_value()) {
-    const Square en_passant_square = position.en_passant_square.value();
-    pawns_copy = our_pawns;
+    // En passant captures
+    if (position.en_passant_square != NO_SQUARE) {
+      const Square en_passant_square = position.en_passant_square;
+      pawns_copy = our_pawns & PAWN_ATTACKS[Them][en_passant_square];
+
+      while (pawns_copy) {
+        const Square from = static_cast<Square>(pop_lsb(pawns_copy));
+        if (info.exact_en_passant
+            && !is_legal_en_passant(position, from, en_passant_square, info.king_square))
+          continue;
 
-    while (pawns_copy) {
-      const Square from = static_cast<Square>(pop_lsb(pawns_copy));
-      if (PAWN_ATTACKS[Us][from] & square_to_bit(en_passant_square)) {
         *moves++ = {from, en_passant_square, EN_PASSANT};
       }
     }
@@ -124,8 +301,102 @@ int MoveGenerator::generate_pawn_moves(const Position &position, Move *moves) co
   return moves - start;
 }
 
+template<PieceColor Us>
+int MoveGenerator::count_pawn_moves(const Position &position, const CheckInfo &info) const {
+  constexpr PieceColor Them = (Us == WHITE) ? BLACK : WHITE;
+  constexpr uint64_t DoublePushRank = (Us == WHITE) ? RANK_3 : RANK_6;
+  constexpr uint64_t PromotionRank = (Us == WHITE) ? RANK_8 : RANK_1;
+
+  const uint64_t our_pawns = position.bitboards[bitboard_index(Us, PIECE_PAWN)];
+  const uint64_t enemy_pieces = position.occupancy[Them] & info.check_mask;
+  const uint64_t empty_squares = ~position.occupancy[ANY];
+
+  auto push = [](uint64_t pawns) { return (Us == WHITE) ? pawns << NORTH : pawns >> (-SOUTH); };
+  auto with_promotions = [](uint64_t targets) {
+    return count_bits(targets & ~PromotionRank) + 4 * count_bits(targets & PromotionRank);
+  };
+
+  // Unpinned pawns are counted set-wise
+  const uint64_t free_pawns = our_pawns & ~info.pinned;
+  const uint64_t single_pushes = push(free_pawns) & empty_squares;
+  const uint64_t double_pushes = push(single_pushes & DoublePushRank) & empty_squares;
+
+  uint64_t west_captures, east_captures;
+  if constexpr (Us == WHITE) {
+    west_captures = (free_pawns & ~FILE_A) << 7;
+    east_captures = (free_pawns & ~FILE_H) << 9;
+  } else {
+    west_captures = (free_pawns & ~FILE_A) >> 9;
+    east_captures = (free_pawns & ~FILE_H) >> 7;
+  }
+
+  int count = with_promotions(single_pushes & info.check_mask)
+              + count_bits(double_pushes & info.check_mask)
+              + with_promotions(west_captures & enemy_pieces)
+              + with_promotions(east_captures & enemy_pieces);
+
+  // Pinned pawns keep only the targets on their pin line
+  uint64_t pinned_pawns = our_pawns & info.pinned;
+  while (pinned_pawns) {
+    const Square from = static_cast<Square>(pop_lsb(pinned_pawns));
+    const uint64_t single_push = push(square_to_bit(from)) & empty_squares;
+
+    uint64_t targets = PAWN_ATTACKS[Us][from] & enemy_pieces;
+    targets |= (single_push | (push(single_push & DoublePushRank) & empty_squares))
+               & info.check_mask;
+
+    count += with_promotions(targets & line_bb(info.king_square, from));
+  }
+
+  if (position.en_passant_square != NO_SQUARE) {
+    uint64_t candidates = our_pawns & PAWN_ATTACKS[Them][position.en_passant_square];
+    while (candidates) {
+      const Square from = static_cast<Square>(pop_lsb(candidates));
+      count += is_legal_en_passant(position, from, position.en_passant_square, info.king_square);
+    }
+  }
+
+  return count;
+}
+
 template<PieceType PieceT>
-int MoveGenerator::generate_piece_moves(const Position &position, Move *moves) const {
+int MoveGenerator::count_piece_moves(const Position &position, const CheckInfo &info) const {
+  const PieceColor us = position.to_move;
+  const uint64_t occupancy = position.occupancy[ANY];
+  const uint64_t targets = ~position.occupancy[us] & info.check_mask;
+
+  uint64_t pieces = position.bitboards[bitboard_index(us, PieceT)];
+  if constexpr (PieceT == PIECE_KNIGHT) pieces &= ~info.pinned; // Knights never move along a pin
+
+  int count = 0;
+  while (pieces) {
+    const Square from = static_cast<Square>(pop_lsb(pieces));
+    uint64_t attacks;
+
+    if constexpr (PieceT == PIECE_KNIGHT) {
+      attacks = KNIGHT_ATTACKS[from];
+    } else if constexpr (PieceT == PIECE_BISHOP) {
+      attacks = get_bishop_attacks(from, occupancy);
+    } else if constexpr (PieceT == PIECE_ROOK) {
+      attacks = get_rook_attacks(from, occupancy);
+    } else if constexpr (PieceT == PIECE_QUEEN) {
+      attacks = get_rook_attacks(from, occupancy) | get_bishop_attacks(from, occupancy);
+    }
+
+    attacks &= targets;
+    if (info.pinned & square_to_bit(from)) attacks &= line_bb(info.king_square, from);
+    count += count_bits(attacks);
+  }
+
+  return count;
+}
+
+template<PieceType PieceT, GenType Gen>
+int MoveGenerator::generate_piece_moves(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const {
   Move *start = moves;
   const PieceColor us = position.to_move;
   const PieceColor them = opposite_color(us);
@@ -152,6 +423,15 @@ int MoveGenerator::generate_piece_moves(const Position &position, Move *moves) c
     }
 
     attacks &= ~our_occupancy;
+    if constexpr (Gen == GEN_CAPTURES) attacks &= enemy_occupancy;
+    if constexpr (Gen == GEN_QUIETS) attacks &= ~enemy_occupancy;
+
+    if constexpr (PieceT == PIECE_KING) {
+      attacks &= ~info.king_danger;
+    } else {
+      attacks &= info.check_mask;
+      if (info.pinned & square_to_bit(from)) attacks &= line_bb(info.king_square, from);
+    }
 
     while (attacks) {
       const Square to = static_cast<Square>(pop_lsb(attacks));
@@ -166,12 +446,28 @@ int MoveGenerator::generate_piece_moves(const Position &position, Move *moves) c
 
 int MoveGenerator::generate_castling_moves(const Position &position, Move *moves) const {
   Move *start = moves;
+  uint64_t destinations = castling_destinations(position);
+  if (!destinations) return 0;
+
+  const Square king_square = find_king(position, position.to_move);
+  while (destinations) {
+    *moves++ = {king_square, static_cast<Square>(pop_lsb(destinations)), CASTLING};
+  }
+
+  return moves - start;
+}
+
+/**
+ * @brief King destination squares of every castling move available to the side to move.
+ */
+uint64_t MoveGenerator::castling_destinations(const Position &position) const {
   const PieceColor us = position.to_move;
   const PieceColor them = opposite_color(us);
 
   if (position.castling_rights == 0) return 0;
 
   const Square king_square = find_king(position, us);
+  uint64_t destinations = 0;
 
   // King-side castling
   if ((us == WHITE && (position.castling_rights & WHITE_CASTLE_KING))
@@ -183,7 +479,7 @@ int MoveGenerator::generate_castling_moves(const Position &position, Move *moves
         && !is_square_attacked(position, king_square, them)
         && !is_square_attacked(position, middle_square, them)
         && !is_square_attacked(position, king_dest, them)) {
-      *moves++ = {king_square, king_dest, CASTLING};
+      destinations |= square_to_bit(king_dest);
     }
   }
 
@@ -199,11 +495,11 @@ int MoveGenerator::generate_castling_moves(const Position &position, Move *moves
         && !is_square_attacked(position, king_square, them)
         && !is_square_attacked(position, middle_square, them)
         && !is_square_attacked(position, king_dest, them)) {
-      *moves++ = {king_square, king_dest, CASTLING};
+      destinations |= square_to_bit(king_dest);
     }
   }
 
-  return moves - start;
+  return destinations;
 }
 
 bool MoveGenerator::is_square_attacked(
@@ -248,30 +544,315 @@ bool MoveGenerator::is_in_check(const Position &position, PieceColor color) cons
   return is_square_attacked(position, king_square, opposite_color(color));
 }
 
-bool MoveGenerator::is_legal_move(const Position &position, const Move &move) const {
-  Position temp_position = position;
-  temp_position.make_move(move);
+/**
+ * @brief Compute checkers, pins, the check evasion mask and king danger squares for the side to
+ * move.
+ */
+CheckInfo MoveGenerator::compute_check_info(const Position &position) const {
+  const PieceColor us = position.to_move;
+  const PieceColor them = opposite_color(us);
+  const uint64_t all_pieces = position.occupancy[ANY];
+
+  CheckInfo info;
+  info.exact_en_passant = true;
+  info.king_square = find_king(position, us);
+  const Square king = info.king_square;
+
+  const uint64_t enemy_queens = position.bitboards[bitboard_index(them, PIECE_QUEEN)];
+  const uint64_t enemy_straight =
+      position.bitboards[bitboard_index(them, PIECE_ROOK)] | enemy_queens;
+  const uint64_t enemy_diagonal =
+      position.bitboards[bitboard_index(them, PIECE_BISHOP)] | enemy_queens;
+
+  info.checkers = (PAWN_ATTACKS[us][king] & position.bitboards[bitboard_index(them, PIECE_PAWN)])
+                  | (KNIGHT_ATTACKS[king] & position.bitboards[bitboard_index(them, PIECE_KNIGHT)]);
+
+  // Sliders aimed at the king through at most one piece either check or pin
+  uint64_t snipers = (get_rook_attacks(king, position.occupancy[them]) & enemy_straight)
+                     | (get_bishop_attacks(king, position.occupancy[them]) & enemy_diagonal);
+  while (snipers) {
+    const int sniper = pop_lsb(snipers);
+    const uint64_t blockers = between_bb(king, sniper) & all_pieces;
+
+    if (!blockers) {
+      info.checkers |= 1ULL << sniper;
+    } else if (count_bits(blockers) == 1 && (blockers & position.occupancy[us])) {
+      info.pinned |= blockers;
+    }
+  }
+
+  if (info.checkers) {
+    const int checker = lsb_index(info.checkers);
+    info.check_mask = count_bits(info.checkers) > 1 ? 0ULL
+                                                    : info.checkers | between_bb(king, checker);
+  }
+
+  info.king_danger = compute_king_danger(position, them);
+  return info;
+}
+
+/**
+ * @brief Squares attacked by enemy_color with the defending king removed, so the king cannot step
+ * back along the ray of a checking slider.
+ */
+uint64_t MoveGenerator::compute_king_danger(
+    const Position &position,
+    PieceColor enemy_color
+) const {
+  const PieceColor defender = opposite_color(enemy_color);
+  const uint64_t occupancy =
+      position.occupancy[ANY] & ~position.bitboards[bitboard_index(defender, PIECE_KING)];
+
+  const uint64_t pawns = position.bitboards[bitboard_index(enemy_color, PIECE_PAWN)];
+  uint64_t danger;
+  if (enemy_color == WHITE) {
+    danger = ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9);
+  } else {
+    danger = ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+  }
+
+  uint64_t knights = position.bitboards[bitboard_index(enemy_color, PIECE_KNIGHT)];
+  while (knights) {
+    danger |= KNIGHT_ATTACKS[pop_lsb(knights)];
+  }
+
+  const uint64_t queens = position.bitboards[bitboard_index(enemy_color, PIECE_QUEEN)];
+  uint64_t diagonal = position.bitboards[bitboard_index(enemy_color, PIECE_BISHOP)] | queens;
+  while (diagonal) {
+    danger |= get_bishop_attacks(pop_lsb(diagonal), occupancy);
+  }
+
+  uint64_t straight = position.bitboards[bitboard_index(enemy_color, PIECE_ROOK)] | queens;
+  while (straight) {
+    danger |= get_rook_attacks(pop_lsb(straight), occupancy);
+  }
+
+  danger |= KING_ATTACKS[find_king(position, enemy_color)];
+  return danger;
+}
+
+/**
+ * @brief En passant removes two pieces from the capturing rank at once, so pins cannot describe
+ * it. Replay the occupancy change and look for any attacker left on the king.
+ */
+bool MoveGenerator::is_legal_en_passant(
+    const Position &position,
+    Square from,
+    Square to,
+    Square king
+) const {
+  const PieceColor us = position.to_move;
+  const PieceColor them = opposite_color(us);
+  const uint64_t captured = square_to_bit(indexes_to_square(square_rank(from), square_file(to)));
+  const uint64_t occupancy =
+      (position.occupancy[ANY] ^ square_to_bit(from) ^ captured) | square_to_bit(to);
+
+  const uint64_t queens = position.bitboards[bitboard_index(them, PIECE_QUEEN)];
+  const uint64_t straight = position.bitboards[bitboard_index(them, PIECE_ROOK)] | queens;
+  const uint64_t diagonal = position.bitboards[bitboard_index(them, PIECE_BISHOP)] | queens;
 
-  if (is_in_check(temp_position, position.to_move)) return false;
+  if (get_rook_attacks(king, occupancy) & straight) return false;
+  if (get_bishop_attacks(king, occupancy) & diagonal) return false;
+  if (KNIGHT_ATTACKS[king] & position.bitboards[bitboard_index(them, PIECE_KNIGHT)]) return false;
+  if (PAWN_ATTACKS[us][king] & position.bitboards[bitboard_index(them, PIECE_PAWN)] & ~captured)
+    return false;
 
   return true;
 }
 
+/**
+ * @brief Enemy pieces giving check to the side to move.
+ */
+uint64_t MoveGenerator::get_checkers(const Position &position) const {
+  const PieceColor us = position.to_move;
+  const PieceColor them = opposite_color(us);
+  const Square king = find_king(position, us);
+  const uint64_t all_pieces = position.occupancy[ANY];
+
+  const uint64_t queens = position.bitboards[bitboard_index(them, PIECE_QUEEN)];
+  const uint64_t straight = position.bitboards[bitboard_index(them, PIECE_ROOK)] | queens;
+  const uint64_t diagonal = position.bitboards[bitboard_index(them, PIECE_BISHOP)] | queens;
+
+  return (PAWN_ATTACKS[us][king] & position.bitboards[bitboard_index(them, PIECE_PAWN)])
+         | (KNIGHT_ATTACKS[king] & position.bitboards[bitboard_index(them, PIECE_KNIGHT)])
+         | (get_bishop_attacks(king, all_pieces) & diagonal)
+         | (get_rook_attacks(king, all_pieces) & straight);
+}
+
+/**
+ * @brief Pieces of both colors attacking a square, with sliders blocked by the given occupancy
+ * rather than the board's, so removed pieces can reveal x-ray attackers behind them.
+ */
+uint64_t MoveGenerator::attackers_to(
+    const Position &position,
+    Square square,
+    uint64_t occupancy
+) const {
+  const uint64_t *bitboards = position.bitboards;
+  const uint64_t straight = bitboards[WHITE_ROOK] | bitboards[BLACK_ROOK] | bitboards[WHITE_QUEEN]
+                            | bitboards[BLACK_QUEEN];
+  const uint64_t diagonal = bitboards[WHITE_BISHOP] | bitboards[BLACK_BISHOP]
+                            | bitboards[WHITE_QUEEN] | bitboards[BLACK_QUEEN];
+
+  return (PAWN_ATTACKS[BLACK][square] & bitboards[WHITE_PAWN])
+         | (PAWN_ATTACKS[WHITE][square] & bitboards[BLACK_PAWN])
+         | (KNIGHT_ATTACKS[square] & (bitboards[WHITE_KNIGHT] | bitboards[BLACK_KNIGHT]))
+         | (KING_ATTACKS[square] & (bitboards[WHITE_KING] | bitboards[BLACK_KING]))
+         | (get_rook_attacks(square, occupancy) & straight)
+         | (get_bishop_attacks(square, occupancy) & diagonal);
+}
+
+/**
+ * @brief Static exchange evaluation: material won by the moving side, in centipawns, if both sides
+ * keep recapturing on the destination with their least valuable attacker and may stop whenever
+ * continuing loses. Sliders behind a capturing piece join in as it leaves. Pins and checks are
+ * ignored, and only bitboards are touched.
+ */
+int MoveGenerator::see(const Position &position, const Move &move) const {
+  if (move.is_castling()) return 0;
+
+  const Square to = move.to;
+  const uint64_t *bitboards = position.bitboards;
+  const uint64_t diagonal = bitboards[WHITE_BISHOP] | bitboards[BLACK_BISHOP]
+                            | bitboards[WHITE_QUEEN] | bitboards[BLACK_QUEEN];
+  const uint64_t straight = bitboards[WHITE_ROOK] | bitboards[BLACK_ROOK] | bitboards[WHITE_QUEEN]
+                            | bitboards[BLACK_QUEEN];
+
+  uint64_t occupancy = position.occupancy[ANY] ^ square_to_bit(move.from);
+  int gain[32];
+  int depth = 0;
+
+  const Piece mover = decode_piece(position.lookup_table[move.from]);
+  if (move.is_en_passant()) {
+    occupancy ^= square_to_bit(indexes_to_square(square_rank(move.from), square_file(to)));
+    gain[0] = PIECE_VALUES[PIECE_PAWN];
+  } else {
+    gain[0] = move.is_capture() ? PIECE_VALUES[decode_type(position.lookup_table[to])] : 0;
+  }
+
+  PieceType on_square = mover.type;
+  if (move.is_promotion()) {
+    gain[0] += PIECE_VALUES[move.promotion_piece] - PIECE_VALUES[PIECE_PAWN];
+    on_square = move.promotion_piece;
+  }
+
+  uint64_t attackers = attackers_to(position, to, occupancy) & occupancy;
+  PieceColor side = opposite_color(mover.color);
+
+  while (true) {
+    const uint64_t side_attackers = attackers & position.occupancy[side];
+    if (!side_attackers) break;
+
+    // Least valuable attacker
+    PieceType attacker = PIECE_PAWN;
+    uint64_t candidates = 0;
+    for (; attacker <= PIECE_KING; attacker = static_cast<PieceType>(attacker + 1)) {
+      candidates = side_attackers & bitboards[bitboard_index(side, attacker)];
+      if (candidates) break;
+    }
+
+    // The king may only recapture when nothing defends the square any more
+    if (attacker == PIECE_KING && (attackers & position.occupancy[opposite_color(side)])) break;
+
+    // Stop once neither side can profit from this capture, it would not be played
+    depth++;
+    gain[depth] = PIECE_VALUES[on_square] - gain[depth - 1];
+    if (std::max(-gain[depth - 1], gain[depth]) < 0) {
+      depth--;
+      break;
+    }
+
+    occupancy ^= candidates & -candidates;
+    if (attacker == PIECE_PAWN || attacker == PIECE_BISHOP || attacker == PIECE_QUEEN) {
+      attackers |= get_bishop_attacks(to, occupancy) & diagonal;
+    }
+    if (attacker == PIECE_ROOK || attacker == PIECE_QUEEN) {
+      attackers |= get_rook_attacks(to, occupancy) & straight;
+    }
+    attackers &= occupancy;
+
+    on_square = attacker;
+    side = opposite_color(side);
+  }
+
+  while (depth > 0) {
+    gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    depth--;
+  }
+
+  return gain[0];
+}
+
+/**
+ * @brief Pieces of a color, other than the king, that the opponent can capture with a winning
+ * exchange.
+ */
+uint64_t MoveGenerator::hanging_pieces(const Position &position, PieceColor color) const {
+  const PieceColor enemy = opposite_color(color);
+  const uint64_t occupancy = position.occupancy[ANY];
+  const uint64_t king = position.bitboards[bitboard_index(color, PIECE_KING)];
+  uint64_t pieces = position.occupancy[color] & ~king;
+  uint64_t hanging = 0;
+
+  while (pieces) {
+    const Square square = static_cast<Square>(pop_lsb(pieces));
+    const uint64_t enemy_attackers =
+        attackers_to(position, square, occupancy) & position.occupancy[enemy];
+    if (!enemy_attackers) continue;
+
+    // The cheapest attacker gives the best exchange
+    for (int type = PIECE_PAWN; type <= PIECE_KING; type++) {
+      const uint64_t candidates =
+          enemy_attackers & position.bitboards[bitboard_index(enemy, static_cast<PieceType>(type))];
+      if (!candidates) continue;
+
+      const Move capture = {static_cast<Square>(lsb_index(candidates)), square, CAPTURE};
+      if (see(position, capture) > 0) hanging |= square_to_bit(square);
+      break;
+    }
+  }
+
+  return hanging;
+}
+
 Square MoveGenerator::find_king(const Position &position, PieceColor color) const {
   const uint64_t king = position.bitboards[bitboard_index(color, PIECE_KING)];
   return static_cast<Square>(lsb_index(king));
 }
 
-template int MoveGenerator::generate_pawn_moves<WHITE>(const Position &position, Move *moves) const;
-template int MoveGenerator::generate_pawn_moves<BLACK>(const Position &position, Move *moves) const;
-
-template int
-    MoveGenerator::generate_piece_moves<PIECE_KNIGHT>(const Position &position, Move *moves) const;
-template int
-    MoveGenerator::generate_piece_moves<PIECE_BISHOP>(const Position &position, Move *moves) const;
-template int
-    MoveGenerator::generate_piece_moves<PIECE_ROOK>(const Position &position, Move *moves) const;
-template int
-    MoveGenerator::generate_piece_moves<PIECE_QUEEN>(const Position &position, Move *moves) const;
-template int
-    MoveGenerator::generate_piece_moves<PIECE_KING>(const Position &position, Move *moves) const;
+template int MoveGenerator::generate_pawn_moves<WHITE>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+template int MoveGenerator::generate_pawn_moves<BLACK>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+
+template int MoveGenerator::generate_piece_moves<PIECE_KNIGHT>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+template int MoveGenerator::generate_piece_moves<PIECE_BISHOP>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+template int MoveGenerator::generate_piece_moves<PIECE_ROOK>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+template int MoveGenerator::generate_piece_moves<PIECE_QUEEN>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
+template int MoveGenerator::generate_piece_moves<PIECE_KING>(
+    const Position &position,
+    const CheckInfo &info,
+    Move *moves
+) const;
@@ -0,0 +1,201 @@
+#include "move_picker.hpp"
+
+#include "chess_types.hpp"
+#include "evaluate.hpp"
+
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Swap the highest scored move in [index, count) into index, so ordering costs nothing for
+ * moves never reached after a cutoff.
+ */
+void pick_best(MoveList &moves, int *scores, int index) {
+  int best = index;
+  for (int i = index + 1; i < moves.count; i++) {
+    if (scores[i] > scores[best]) best = i;
+  }
+
+  std::swap(moves[index], moves[best]);
+  std::swap(scores[index], scores[best]);
+}
+
+} // namespace
+
+void MovePicker::reset(
+    const Position &position,
+    const MoveGenerator &generator,
+    uint16_t hash_move,
+    const Move *killers,
+    const History *history,
+    bool captures_only
+) {
+  this->position = &position;
+  this->generator = &generator;
+  this->history = history;
+  this->captures_only = captures_only;
+  this->hash_move = hash_move;
+  this->killers[0] = killers ? encode_move(killers[0]) : 0;
+  this->killers[1] = killers ? encode_move(killers[1]) : 0;
+
+  killer_index = 0;
+  capture_index = 0;
+  losing_count = 0;
+  quiet_index = 0;
+  stage = hash_move ? STAGE_HASH_MOVE : STAGE_GENERATE_CAPTURES;
+}
+
+bool MovePicker::next(Move &move) {
+  switch (stage) {
+    case STAGE_HASH_MOVE: {
+      stage = STAGE_GENERATE_CAPTURES;
+      move = decode(hash_move);
+      if ((!captures_only || move.is_capture() || move.is_promotion())
+          && generator->is_legal(*position, move))
+        return true;
+
+      hash_move = 0;
+      [[fallthrough]];
+    }
+
+    case STAGE_GENERATE_CAPTURES: {
+      generator->generate_legal_captures(*position, captures);
+      for (int i = 0; i < captures.count; i++) {
+        const Move &capture = captures[i];
+        const PieceType victim =
+            capture.is_en_passant() ? PIECE_PAWN : decode_type(position->lookup_table[capture.to]);
+        const PieceType attacker = decode_type(position->lookup_table[capture.from]);
+
+        // Most valuable victim first, least valuable attacker breaks ties
+        capture_scores[i] = 10 * PIECE_VALUES[victim] - PIECE_VALUES[attacker];
+        if (capture.is_promotion()) capture_scores[i] += PIECE_VALUES[capture.promotion_piece];
+      }
+
+      stage = STAGE_WINNING_CAPTURES;
+      [[fallthrough]];
+    }
+
+    case STAGE_WINNING_CAPTURES: {
+      while (capture_index < captures.count) {
+        pick_best(captures, capture_scores, capture_index);
+        move = captures[capture_index++];
+        if (encode_move(move) == hash_move) continue;
+
+        if (is_losing_capture(move)) {
+          captures[losing_count++] = move;
+          continue;
+        }
+
+        return true;
+      }
+
+      // Quiescence only wants captures that can gain material
+      stage = captures_only ? STAGE_DONE : STAGE_KILLERS;
+      return next(move);
+    }
+
+    case STAGE_KILLERS: {
+      while (killer_index < 2) {
+        const uint16_t code = killers[killer_index++];
+        if (code == 0 || code == hash_move) continue;
+
+        move = decode(code);
+        if (!move.is_capture() && !move.is_promotion() && generator->is_legal(*position, move))
+          return true;
+      }
+
+      stage = STAGE_GENERATE_QUIETS;
+      [[fallthrough]];
+    }
+
+    case STAGE_GENERATE_QUIETS: {
+      generator->generate_legal_quiets(*position, quiets);
+      for (int i = 0; i < quiets.count; i++) {
+        const Move &quiet = quiets[i];
+        quiet_scores[i] = history ? (*history)[position->to_move][quiet.from][quiet.to] : 0;
+      }
+
+      stage = STAGE_QUIETS;
+      [[fallthrough]];
+    }
+
+    case STAGE_QUIETS: {
+      while (quiet_index < quiets.count) {
+        pick_best(quiets, quiet_scores, quiet_index);
+        move = quiets[quiet_index++];
+        if (!already_tried(move)) return true;
+      }
+
+      stage = STAGE_LOSING_CAPTURES;
+      capture_index = 0;
+      [[fallthrough]];
+    }
+
+    case STAGE_LOSING_CAPTURES: {
+      if (capture_index < losing_count) {
+        move = captures[capture_index++];
+        return true;
+      }
+
+      stage = STAGE_DONE;
+      [[fallthrough]];
+    }
+
+    case STAGE_DONE: break;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Whether a generated quiet move was already returned as the hash move or a killer.
+ */
+bool MovePicker::already_tried(const Move &move) const {
+  const uint16_t code = encode_move(move);
+  if (code == hash_move) return true;
+
+  for (int i = 0; i < killer_index; i++) {
+    if (code == killers[i]) return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief A capture that loses material once the exchange on its square is played out. Captures
+ * of a piece at least as valuable as the capturer can never lose, so SEE is skipped for them.
+ */
+bool MovePicker::is_losing_capture(const Move &move) const {
+  if (move.is_en_passant()) return false;
+
+  const PieceType victim = decode_type(position->lookup_table[move.to]);
+  const PieceType attacker = decode_type(position->lookup_table[move.from]);
+  if (PIECE_VALUES[victim] >= PIECE_VALUES[attacker]) return false;
+
+  return generator->see(*position, move) < 0;
+}
+
+/**
+ * @brief Rebuild a full move from its 16-bit code, taking the type flags from the board. The
+ * result still has to pass MoveGenerator::is_legal.
+ */
+Move MovePicker::decode(uint16_t code) const {
+  Move move;
+  move.from = static_cast<Square>(code & 0x3F);
+  move.to = static_cast<Square>((code >> 6) & 0x3F);
+  move.promotion_piece = static_cast<PieceType>((code >> 12) & 0x7);
+
+  const PieceType type = decode_type(position->lookup_table[move.from]);
+  const uint64_t enemies = position->occupancy[opposite_color(position->to_move)];
+
+  int flags = (enemies & square_to_bit(move.to)) ? CAPTURE : NORMAL_MOVE;
+  if (type == PIECE_PAWN && move.to == position->en_passant_square) flags = EN_PASSANT;
+  if (type == PIECE_KING && (move.to == move.from + 2 || move.to + 2 == move.from)) {
+    flags = CASTLING;
+  }
+  if (move.promotion_piece != PIECE_NONE) flags |= PROMOTION;
+
+  move.type = static_cast<MoveType>(flags);
+  return move;
+}
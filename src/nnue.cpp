@@ -0,0 +1,291 @@
+#include "nnue.hpp"
+
+#include "chess_types.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr char NNUE_MAGIC[8] = {'C', 'L', 'E', 'S', 'S', 'N', 'N', '1'};
+constexpr int MAX_REFRESH_COLUMNS = 32; // Every piece but the two kings
+
+/**
+ * @brief out = in + sum(adds) - sum(subs) over size int16 lanes. size is a multiple of 16, so the
+ * vector loops need no tail.
+ */
+void add_sub(
+    const int16_t *in,
+    int16_t *out,
+    int size,
+    const int16_t *const *adds,
+    int add_count,
+    const int16_t *const *subs,
+    int sub_count
+) {
+#if defined(__AVX2__)
+  for (int i = 0; i < size; i += 16) {
+    __m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    for (int a = 0; a < add_count; a++) {
+      const __m256i *column = reinterpret_cast<const __m256i *>(adds[a] + i);
+      sum = _mm256_add_epi16(sum, _mm256_loadu_si256(column));
+    }
+    for (int s = 0; s < sub_count; s++) {
+      const __m256i *column = reinterpret_cast<const __m256i *>(subs[s] + i);
+      sum = _mm256_sub_epi16(sum, _mm256_loadu_si256(column));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), sum);
+  }
+#elif defined(__SSE2__)
+  for (int i = 0; i < size; i += 8) {
+    __m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    for (int a = 0; a < add_count; a++) {
+      const __m128i *column = reinterpret_cast<const __m128i *>(adds[a] + i);
+      sum = _mm_add_epi16(sum, _mm_loadu_si128(column));
+    }
+    for (int s = 0; s < sub_count; s++) {
+      const __m128i *column = reinterpret_cast<const __m128i *>(subs[s] + i);
+      sum = _mm_sub_epi16(sum, _mm_loadu_si128(column));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sum);
+  }
+#else
+  for (int i = 0; i < size; i++) {
+    int16_t sum = in[i];
+    for (int a = 0; a < add_count; a++) sum = static_cast<int16_t>(sum + adds[a][i]);
+    for (int s = 0; s < sub_count; s++) sum = static_cast<int16_t>(sum - subs[s][i]);
+    out[i] = sum;
+  }
+#endif
+}
+
+/**
+ * @brief Dot product of the clipped ReLU of values with weights. Activations stay below 256, so
+ * every pairwise multiply-add fits in an int32 lane.
+ */
+int32_t clipped_dot(const int16_t *values, const int16_t *weights, int size) {
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ceiling = _mm256_set1_epi16(NNUE_ACTIVATION_MAX);
+  __m256i sum = _mm256_setzero_si256();
+  for (int i = 0; i < size; i += 16) {
+    __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    value = _mm256_min_epi16(_mm256_max_epi16(value, zero), ceiling);
+    const __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+  }
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+  return _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ceiling = _mm_set1_epi16(NNUE_ACTIVATION_MAX);
+  __m128i sum = _mm_setzero_si128();
+  for (int i = 0; i < size; i += 8) {
+    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    value = _mm_min_epi16(_mm_max_epi16(value, zero), ceiling);
+    const __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+  return _mm_cvtsi128_si32(sum);
+#else
+  int32_t sum = 0;
+  for (int i = 0; i < size; i++) {
+    const int value = std::clamp<int>(values[i], 0, NNUE_ACTIVATION_MAX);
+    sum += value * weights[i];
+  }
+  return sum;
+#endif
+}
+
+int feature_index(PieceColor perspective, int king, const NnueDirty::Change &piece) {
+  int square = piece.square;
+  if (perspective == BLACK) {
+    king ^= 56;
+    square ^= 56;
+  }
+
+  const int piece_index = (piece.type - 1) * 2 + (piece.color != perspective);
+  return (king * 10 + piece_index) * 64 + square;
+}
+
+template<typename T>
+void read_values(std::istream &stream, T *values, size_t count) {
+  stream.read(reinterpret_cast<char *>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+} // namespace
+
+NnueNetwork::NnueNetwork(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("Failed to open NNUE file " + path + ".");
+  load(file);
+}
+
+NnueNetwork::NnueNetwork(std::istream &stream) { load(stream); }
+
+void NnueNetwork::load(std::istream &stream) {
+  char magic[8]{};
+  uint32_t inputs = 0, hidden_size = 0;
+  read_values(stream, magic, 8);
+  read_values(stream, &inputs, 1);
+  read_values(stream, &hidden_size, 1);
+
+  if (!stream || std::memcmp(magic, NNUE_MAGIC, 8) != 0) {
+    throw std::runtime_error("NNUE file has an unknown format.");
+  }
+  if (inputs != NNUE_INPUTS || hidden_size == 0 || hidden_size % 16 != 0
+      || hidden_size > NNUE_MAX_HIDDEN) {
+    throw std::runtime_error("NNUE file has unsupported dimensions.");
+  }
+
+  hidden = static_cast<int>(hidden_size);
+  feature_biases.resize(hidden);
+  feature_weights.resize(static_cast<size_t>(NNUE_INPUTS) * hidden);
+  output_weights.resize(2 * hidden);
+
+  read_values(stream, feature_biases.data(), feature_biases.size());
+  read_values(stream, feature_weights.data(), feature_weights.size());
+  read_values(stream, output_weights.data(), output_weights.size());
+  read_values(stream, &output_bias, 1);
+
+  if (!stream) throw std::runtime_error("NNUE file is truncated.");
+}
+
+const int16_t *NnueNetwork::column(
+    PieceColor perspective,
+    Square king,
+    const NnueDirty::Change &piece
+) const {
+  const size_t index = static_cast<size_t>(feature_index(perspective, king, piece));
+  return feature_weights.data() + index * hidden;
+}
+
+void NnueNetwork::refresh(const Position &position, NnueAccumulator &accumulator) const {
+  refresh(position, WHITE, accumulator);
+  refresh(position, BLACK, accumulator);
+}
+
+void NnueNetwork::refresh(
+    const Position &position,
+    PieceColor perspective,
+    NnueAccumulator &accumulator
+) const {
+  const Square king =
+      static_cast<Square>(lsb_index(position.bitboards[bitboard_index(perspective, PIECE_KING)]));
+
+  const int16_t *columns[MAX_REFRESH_COLUMNS];
+  int count = 0;
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int type = PIECE_PAWN; type < PIECE_KING; type++) {
+      const PieceColor piece_color = static_cast<PieceColor>(color);
+      const PieceType piece_type = static_cast<PieceType>(type);
+      uint64_t pieces = position.bitboards[bitboard_index(piece_color, piece_type)];
+      while (pieces && count < MAX_REFRESH_COLUMNS) {
+        const Square square = static_cast<Square>(pop_lsb(pieces));
+        columns[count++] = column(perspective, king, {piece_color, piece_type, square});
+      }
+    }
+  }
+
+  add_sub(
+      feature_biases.data(),
+      accumulator.values[perspective],
+      hidden,
+      columns,
+      count,
+      nullptr,
+      0
+  );
+}
+
+void NnueNetwork::update(
+    const Position &position,
+    const NnueDirty &dirty,
+    const NnueAccumulator &parent,
+    NnueAccumulator &child
+) const {
+  for (PieceColor perspective : {WHITE, BLACK}) {
+    if (dirty.king_moved == perspective) {
+      refresh(position, perspective, child);
+      continue;
+    }
+
+    const Square king =
+        static_cast<Square>(lsb_index(position.bitboards[bitboard_index(perspective, PIECE_KING)]));
+
+    const int16_t *adds[2];
+    const int16_t *subs[2];
+    for (int i = 0; i < dirty.added_count; i++) adds[i] = column(perspective, king, dirty.added[i]);
+    for (int i = 0; i < dirty.removed_count; i++) {
+      subs[i] = column(perspective, king, dirty.removed[i]);
+    }
+
+    add_sub(
+        parent.values[perspective],
+        child.values[perspective],
+        hidden,
+        adds,
+        dirty.added_count,
+        subs,
+        dirty.removed_count
+    );
+  }
+}
+
+int NnueNetwork::evaluate(const Position &position, const NnueAccumulator &accumulator) const {
+  const PieceColor us = position.to_move;
+  const PieceColor them = opposite_color(us);
+
+  const int16_t *weights = output_weights.data();
+  const int64_t output = int64_t{output_bias} + clipped_dot(accumulator.values[us], weights, hidden)
+                         + clipped_dot(accumulator.values[them], weights + hidden, hidden);
+  return static_cast<int>(output * NNUE_OUTPUT_SCALE / (NNUE_ACTIVATION_MAX * NNUE_WEIGHT_SCALE));
+}
+
+/**
+ * @brief Must be called on the position before the move. Kings are not features, a king move is
+ * recorded in king_moved instead since it changes every feature of that perspective.
+ */
+NnueDirty NnueNetwork::dirty_pieces(const Position &position, const Move &move) {
+  NnueDirty dirty;
+  const Piece moved = position.get_piece_at(move.from);
+
+  if (moved.type == PIECE_KING) {
+    dirty.king_moved = moved.color;
+  } else {
+    const PieceType placed = move.is_promotion() ? move.promotion_piece : moved.type;
+    dirty.removed[dirty.removed_count++] = {moved.color, moved.type, move.from};
+    dirty.added[dirty.added_count++] = {moved.color, placed, move.to};
+  }
+
+  if (move.is_capture()) {
+    const Square captured_square =
+        move.is_en_passant()
+            ? indexes_to_square(square_rank(move.from), square_file(move.to))
+            : move.to;
+    const Piece captured = position.get_piece_at(captured_square);
+    dirty.removed[dirty.removed_count++] = {captured.color, captured.type, captured_square};
+  }
+
+  if (move.is_castling()) {
+    const bool kingside = move.to > move.from;
+    const Square rook_from = static_cast<Square>(kingside ? move.from + 3 : move.from - 4);
+    const Square rook_to = static_cast<Square>(kingside ? move.from + 1 : move.from - 1);
+    dirty.removed[dirty.removed_count++] = {moved.color, PIECE_ROOK, rook_from};
+    dirty.added[dirty.added_count++] = {moved.color, PIECE_ROOK, rook_to};
+  }
+
+  return dirty;
+}
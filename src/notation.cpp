@@ -0,0 +1,69 @@
+#include "notation.hpp"
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Algebraic name of a square, e.g. "e4".
+ */
+std::string square_to_string(Square square) {
+  std::string name;
+  name += static_cast<char>('a' + square_file(square));
+  name += static_cast<char>('1' + square_rank(square));
+  return name;
+}
+
+/**
+ * @brief Long algebraic UCI notation of a move, e.g. "e2e4" or "e7e8q".
+ */
+std::string move_to_uci(const Move &move) {
+  std::string uci = square_to_string(move.from) + square_to_string(move.to);
+
+  if (move.is_promotion()) {
+    switch (move.promotion_piece) {
+      case PIECE_QUEEN: uci += 'q'; break;
+      case PIECE_ROOK: uci += 'r'; break;
+      case PIECE_BISHOP: uci += 'b'; break;
+      case PIECE_KNIGHT: uci += 'n'; break;
+      default: break;
+    }
+  }
+
+  return uci;
+}
+
+/**
+ * @brief Find the legal move written in UCI notation, e.g. "e7e8q". Without a promotion letter a
+ * promotion never matches.
+ */
+bool uci_to_move(std::string_view uci, const MoveList &legal_moves, Move &move) {
+  if (uci.size() != 4 && uci.size() != 5) return false;
+  if (uci[0] < 'a' || uci[0] > 'h' || uci[2] < 'a' || uci[2] > 'h') return false;
+  if (uci[1] < '1' || uci[1] > '8' || uci[3] < '1' || uci[3] > '8') return false;
+
+  const Square from = indexes_to_square(uci[1] - '1', uci[0] - 'a');
+  const Square to = indexes_to_square(uci[3] - '1', uci[2] - 'a');
+
+  PieceType promotion = PIECE_NONE;
+  if (uci.size() == 5) {
+    switch (uci[4]) {
+      case 'q': promotion = PIECE_QUEEN; break;
+      case 'r': promotion = PIECE_ROOK; break;
+      case 'b': promotion = PIECE_BISHOP; break;
+      case 'n': promotion = PIECE_KNIGHT; break;
+      default: return false;
+    }
+  }
+
+  for (const Move &legal : legal_moves) {
+    if (legal.from == from && legal.to == to && legal.promotion_piece == promotion) {
+      move = legal;
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,27 @@
+#include "pawn_table.hpp"
+
+#include <algorithm>
+
+PawnTable::PawnTable(size_t entry_count) {
+  size_t size = 1;
+  while (size * 2 <= std::max<size_t>(1, entry_count)) {
+    size *= 2;
+  }
+
+  entries = std::make_unique<PawnEntry[]>(size);
+  mask = size - 1;
+}
+
+PawnEntry &PawnTable::probe(uint64_t key, bool &found) {
+  PawnEntry &entry = entries[key & mask];
+  probes++;
+  found = entry.key == key;
+  if (found) hits++;
+  return entry;
+}
+
+void PawnTable::clear() {
+  std::fill(entries.get(), entries.get() + mask + 1, PawnEntry{});
+  probes = 0;
+  hits = 0;
+}
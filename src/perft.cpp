@@ -0,0 +1,318 @@
+#include "perft.hpp"
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+PerftStats &PerftStats::operator+=(const PerftStats &other) {
+  nodes += other.nodes;
+  captures += other.captures;
+  en_passants += other.en_passants;
+  castles += other.castles;
+  promotions += other.promotions;
+  checks += other.checks;
+  discovered_checks += other.discovered_checks;
+  double_checks += other.double_checks;
+  checkmates += other.checkmates;
+  return *this;
+}
+
+PerftTable::PerftTable(size_t size_mb) {
+  size_t bucket_count = 1;
+  const size_t max_buckets = std::max<size_t>(1, (size_mb << 20) / sizeof(Bucket));
+  while (bucket_count * 2 <= max_buckets) {
+    bucket_count *= 2;
+  }
+
+  buckets = std::make_unique<Bucket[]>(bucket_count);
+  bucket_mask = bucket_count - 1;
+}
+
+bool PerftTable::probe(uint64_t key, int depth, uint64_t &nodes) const {
+  for (const Entry &entry : bucket_for(key).entries) {
+    const uint64_t data = entry.data.load(std::memory_order_relaxed);
+    const uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+    if ((check ^ data) == key && static_cast<int>(data & 0xFF) == depth) {
+      nodes = data >> 8;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Overwrite the entry for this key if present, otherwise the shallowest entry, since deep
+ * subtrees are the expensive ones to recount.
+ */
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+  Bucket &bucket = bucket_for(key);
+  Entry *victim = &bucket.entries[0];
+  int victim_depth = 0xFF;
+
+  for (Entry &entry : bucket.entries) {
+    const uint64_t data = entry.data.load(std::memory_order_relaxed);
+    const uint64_t check = entry.check.load(std::memory_order_relaxed);
+    const int entry_depth = static_cast<int>(data & 0xFF);
+
+    if ((check ^ data) == key) {
+      victim = &entry;
+      break;
+    }
+
+    if (entry_depth < victim_depth) {
+      victim = &entry;
+      victim_depth = entry_depth;
+    }
+  }
+
+  const uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth);
+  victim->data.store(data, std::memory_order_relaxed);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+PerftResult Perft::run(const Position &position, int depth) const {
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::unique_ptr<PerftTable> table;
+  if (options.hash_mb > 0) table = std::make_unique<PerftTable>(options.hash_mb);
+
+  PerftResult result;
+  Counters counters;
+  result.nodes = dispatch(position, depth, table.get(), counters);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+  result.seconds = elapsed.count();
+  if (result.seconds > 0) result.nodes_per_second = result.nodes / result.seconds;
+  result.hash_probes = counters.probes;
+  result.hash_hits = counters.hits;
+
+  return result;
+}
+
+/**
+ * @brief Count on the calling thread or the pool, depending on the options.
+ */
+uint64_t Perft::dispatch(
+    const Position &position,
+    int depth,
+    PerftTable *table,
+    Counters &counters
+) const {
+  if (options.threads == 1 || depth <= 1) {
+    Position copy = position;
+    return count_nodes(copy, depth, table, counters);
+  }
+
+  return run_parallel(position, depth, table, counters);
+}
+
+/**
+ * @brief Serial perft without the cache, the position is restored before returning.
+ */
+uint64_t Perft::count(Position &position, int depth) const {
+  Counters counters;
+  return count_nodes(position, depth, nullptr, counters);
+}
+
+uint64_t Perft::count_nodes(
+    Position &position,
+    int depth,
+    PerftTable *table,
+    Counters &counters
+) const {
+  if (depth == 0) return 1;
+  if (depth == 1) return generator.count_legal_moves(position);
+
+  uint64_t nodes = 0;
+  if (table) {
+    counters.probes++;
+    if (table->probe(position.key, depth, nodes)) {
+      counters.hits++;
+      return nodes;
+    }
+  }
+
+  const MoveList moves = generator.generate_legal_moves(position);
+  for (const Move &move : moves) {
+    position.make_move(move);
+    nodes += count_nodes(position, depth - 1, table, counters);
+    position.undo_move();
+  }
+
+  if (table) table->store(position.key, depth, nodes);
+  return nodes;
+}
+
+/**
+ * @brief Serial perft that also classifies every move of the last ply. Much slower than count()
+ * because each leaf move is played to inspect the check it gives.
+ */
+PerftStats Perft::count_stats(Position &position, int depth) const {
+  PerftStats stats;
+  if (depth == 0) {
+    stats.nodes = 1;
+    return stats;
+  }
+
+  const MoveList moves = generator.generate_legal_moves(position);
+  for (const Move &move : moves) {
+    if (depth == 1) {
+      classify_move(position, move, stats);
+      continue;
+    }
+
+    position.make_move(move);
+    stats += count_stats(position, depth - 1);
+    position.undo_move();
+  }
+
+  return stats;
+}
+
+/**
+ * @brief Per root move counts. Plain counts share one cache across root moves and use the pool,
+ * statistics are always gathered serially. Cache counters are added to totals when given.
+ */
+std::vector<DivideEntry> Perft::divide(
+    const Position &position,
+    int depth,
+    bool with_stats,
+    PerftResult *totals
+) const {
+  std::vector<DivideEntry> entries;
+  if (depth < 1) return entries;
+
+  std::unique_ptr<PerftTable> table;
+  if (options.hash_mb > 0 && !with_stats) table = std::make_unique<PerftTable>(options.hash_mb);
+
+  Counters counters;
+  Position root = position;
+  for (const Move &move : generator.generate_legal_moves(root)) {
+    DivideEntry entry{move, {}};
+
+    if (with_stats && depth == 1) {
+      classify_move(root, move, entry.stats);
+    } else {
+      root.make_move(move);
+      if (with_stats) {
+        entry.stats = count_stats(root, depth - 1);
+      } else {
+        entry.stats.nodes = dispatch(root, depth - 1, table.get(), counters);
+      }
+      root.undo_move();
+    }
+
+    entries.push_back(entry);
+  }
+
+  if (totals) {
+    totals->hash_probes += counters.probes;
+    totals->hash_hits += counters.hits;
+  }
+
+  return entries;
+}
+
+/**
+ * @brief Count one leaf move into stats, playing it to see which checks it gives.
+ */
+void Perft::classify_move(Position &position, const Move &move, PerftStats &stats) const {
+  stats.nodes++;
+  stats.captures += move.is_capture();
+  stats.en_passants += move.is_en_passant();
+  stats.castles += move.is_castling();
+  stats.promotions += move.is_promotion();
+
+  // Squares of the pieces that moved, including the rook of a castling move
+  uint64_t moved = square_to_bit(move.to);
+  if (move.is_castling()) {
+    const int rook_to = move.to > move.from ? move.from + EAST : move.from + WEST;
+    moved |= square_to_bit(static_cast<Square>(rook_to));
+  }
+
+  position.make_move(move);
+
+  const uint64_t checkers = generator.get_checkers(position);
+  if (checkers) {
+    stats.checks++;
+    stats.discovered_checks += (checkers & moved) == 0;
+    stats.double_checks += count_bits(checkers) > 1;
+    stats.checkmates += generator.count_legal_moves(position) == 0;
+  }
+
+  position.undo_move();
+}
+
+/**
+ * @brief Expand the first plies into move paths and count each remaining subtree as a pool task.
+ * Every worker replays paths on its own Position copy, so tasks never share board state.
+ */
+uint64_t Perft::run_parallel(
+    const Position &position,
+    int depth,
+    PerftTable *table,
+    Counters &counters
+) const {
+  int threads = options.threads;
+  if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  const int split_depth = std::clamp(options.split_depth, 1, depth - 1);
+
+  std::vector<std::vector<Move>> paths;
+  std::vector<Move> path;
+  Position walker = position;
+
+  auto expand = [&](auto &self, int ply) -> void {
+    if (ply == split_depth) {
+      paths.push_back(path);
+      return;
+    }
+
+    for (const Move &move : generator.generate_legal_moves(walker)) {
+      path.push_back(move);
+      walker.make_move(move);
+      self(self, ply + 1);
+      walker.undo_move();
+      path.pop_back();
+    }
+  };
+  expand(expand, 0);
+
+  ThreadPool pool(threads);
+  std::vector<Position> worker_positions(pool.size(), position);
+  std::atomic<uint64_t> nodes{0};
+  std::mutex counters_mutex;
+  const int remaining_depth = depth - split_depth;
+
+  for (const std::vector<Move> &task_path : paths) {
+    pool.submit([&, task_path]() {
+      Position &local = worker_positions[pool.current_worker()];
+
+      for (const Move &move : task_path) {
+        local.make_move(move);
+      }
+      Counters task_counters;
+      nodes.fetch_add(
+          count_nodes(local, remaining_depth, table, task_counters),
+          std::memory_order_relaxed
+      );
+      for (size_t i = 0; i < task_path.size(); i++) {
+        local.undo_move();
+      }
+
+      std::lock_guard<std::mutex> lock(counters_mutex);
+      counters.probes += task_counters.probes;
+      counters.hits += task_counters.hits;
+    });
+  }
+
+  pool.wait_idle();
+  return nodes.load();
+}
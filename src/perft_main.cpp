@@ -0,0 +1,175 @@
+#include "chess_types.hpp"
+#include "notation.hpp"
+#include "perft.hpp"
+#include "position.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+struct Args {
+  std::string fen = INITIAL_POSITION_FEN;
+  int depth = 5;
+  bool divide = false;
+  bool stats = false;
+  PerftOptions options{};
+};
+
+bool parse_args(int argc, char *argv[], Args &args);
+void print_usage(const char *program);
+void print_stats(const PerftStats &stats, const char *indent);
+std::string json_escape(const std::string &text);
+
+int main(int argc, char *argv[]) {
+  Args args;
+  if (!parse_args(argc, argv, args)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (!is_valid_fen(args.fen)) {
+    fprintf(stderr, "Invalid FEN: %s\n\n", args.fen.c_str());
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (args.stats) {
+    // Statistics are always gathered serially and uncached, report what actually runs
+    args.options.threads = 1;
+    args.options.hash_mb = 0;
+  }
+
+  const Position position(args.fen);
+  const Perft perft(args.options);
+
+  PerftResult result;
+  PerftStats totals;
+  std::vector<DivideEntry> entries;
+
+  if (args.divide || args.stats) {
+    auto start_time = std::chrono::steady_clock::now();
+    entries = perft.divide(position, args.depth, args.stats, &result);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+    for (const DivideEntry &entry : entries) {
+      totals += entry.stats;
+    }
+
+    result.nodes = totals.nodes;
+    result.seconds = elapsed.count();
+    if (result.seconds > 0) result.nodes_per_second = result.nodes / result.seconds;
+  } else {
+    result = perft.run(position, args.depth);
+  }
+
+  printf("{\n");
+  printf("  \"fen\": \"%s\",\n", json_escape(args.fen).c_str());
+  printf("  \"depth\": %d,\n", args.depth);
+  printf("  \"threads\": %d,\n", args.options.threads);
+  printf("  \"hash_mb\": %zu,\n", args.options.hash_mb);
+  printf("  \"nodes\": %lu,\n", result.nodes);
+  printf("  \"seconds\": %.6f,\n", result.seconds);
+  printf("  \"nps\": %.0f", result.nodes_per_second);
+
+  if (result.hash_probes > 0) {
+    printf(",\n  \"hash_probes\": %lu", result.hash_probes);
+    printf(",\n  \"hash_hit_rate\": %.4f", result.hash_hit_rate());
+  }
+
+  if (args.stats) {
+    printf(",\n  \"stats\": {\n");
+    print_stats(totals, "    ");
+    printf("  }");
+  }
+
+  if (args.divide) {
+    printf(",\n  \"divide\": [");
+
+    for (size_t i = 0; i < entries.size(); i++) {
+      const DivideEntry &entry = entries[i];
+      const std::string move = move_to_uci(entry.move);
+
+      printf(i ? ",\n" : "\n");
+      printf("    {\"move\": \"%s\", \"nodes\": %lu", move.c_str(), entry.stats.nodes);
+      if (args.stats) {
+        printf(", \"stats\": {\n");
+        print_stats(entry.stats, "      ");
+        printf("    }");
+      }
+      printf("}");
+    }
+
+    printf("\n  ]");
+  }
+
+  printf("\n}\n");
+  return 0;
+}
+
+bool parse_args(int argc, char *argv[], Args &args) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--divide") {
+      args.divide = true;
+    } else if (arg == "--stats") {
+      args.stats = true;
+    } else if (arg == "--fen" && has_value) {
+      args.fen = argv[++i];
+    } else if (arg == "--depth" && has_value) {
+      args.depth = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && has_value) {
+      args.options.threads = std::atoi(argv[++i]);
+    } else if (arg == "--split" && has_value) {
+      args.options.split_depth = std::atoi(argv[++i]);
+    } else if (arg == "--hash" && has_value) {
+      args.options.hash_mb = std::strtoul(argv[++i], nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+
+  return args.depth >= 0 && args.options.threads >= 0;
+}
+
+void print_usage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [--fen FEN] [--depth N] [--divide] [--stats]\n"
+      "          [--threads N] [--split N] [--hash MB]\n"
+      "\n"
+      "  --fen FEN    Root position (default: initial position)\n"
+      "  --depth N    Search depth in plies (default: 5)\n"
+      "  --divide     Print node counts per root move\n"
+      "  --stats      Break counts down by move type (serial and uncached, slower)\n"
+      "  --threads N  Worker threads, 0 for all cores (default: 1)\n"
+      "  --split N    Plies expanded before splitting into tasks (default: 2)\n"
+      "  --hash MB    Subtree count cache size, 0 disables it (default: 0)\n",
+      program
+  );
+}
+
+/**
+ * @brief Print the move-type counters as JSON object members, one per line.
+ */
+void print_stats(const PerftStats &stats, const char *indent) {
+  printf("%s\"nodes\": %lu,\n", indent, stats.nodes);
+  printf("%s\"captures\": %lu,\n", indent, stats.captures);
+  printf("%s\"en_passants\": %lu,\n", indent, stats.en_passants);
+  printf("%s\"castles\": %lu,\n", indent, stats.castles);
+  printf("%s\"promotions\": %lu,\n", indent, stats.promotions);
+  printf("%s\"checks\": %lu,\n", indent, stats.checks);
+  printf("%s\"discovered_checks\": %lu,\n", indent, stats.discovered_checks);
+  printf("%s\"double_checks\": %lu,\n", indent, stats.double_checks);
+  printf("%s\"checkmates\": %lu\n", indent, stats.checkmates);
+}
+
+std::string json_escape(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\') escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
@@ -1,8 +1,12 @@
 #include "position.hpp"
 
 #include "chess_types.hpp"
+#include "zobrist.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <sstream>
+#include <stdexcept>
 
 void Position::set_fen(const std::string &fen) {
   for (int i = 0; i < 12; i++) {
@@ -14,7 +18,10 @@ void Position::set_fen(const std::string &fen) {
   occupancy[WHITE] = 0;
   occupancy[BLACK] = 0;
   occupancy[ANY] = 0;
-  undo_stack.clear();
+  castling_rights = 0;
+  undo_count = 0;
+  pawn_key = 0;
+  psq = {};
 
   std::istringstream fen_stream(fen);
   std::string piece_placement, active_color, castling, en_passant, halfmove_str, fullmove_str;
@@ -57,9 +64,7 @@ void Position::set_fen(const std::string &fen) {
   // Active color
   to_move = (active_color == "w") ? WHITE : BLACK;
 
-  if (castling == "-") {
-    castling_rights = 0;
-  } else {
+  if (castling != "-") {
     for (char c : castling) {
       switch (c) {
         case 'K': castling_rights |= WHITE_CASTLE_KING; break;
@@ -70,18 +75,22 @@ void Position::set_fen(const std::string &fen) {
     }
   }
 
-  // En passant square
-  if (en_passant == "-") {
-    en_passant_square = std::nullopt;
-  } else {
+  // En passant square, dropped when no pawn can take so equal positions hash equally
+  en_passant_square = NO_SQUARE;
+  if (en_passant != "-" && en_passant.size() >= 2) {
     int file_idx = en_passant[0] - 'a';
     int rank_idx = en_passant[1] - '1'; // -'1' for 0-based index
-    en_passant_square = indexes_to_square(rank_idx, file_idx);
+    const Square ep_square = indexes_to_square(rank_idx, file_idx);
+    const Square pushed_pawn = static_cast<Square>(ep_square + (to_move == WHITE ? SOUTH : NORTH));
+    if (can_capture_en_passant(pushed_pawn, to_move)) en_passant_square = ep_square;
   }
 
   // Halfmove clock and Fullmove counter
   halfmove_clock = halfmove_str.empty() ? 0 : std::stoi(halfmove_str);
   fullmove_counter = fullmove_str.empty() ? 1 : std::stoi(fullmove_str);
+
+  key = compute_key();
+  pawn_key = compute_pawn_key();
 }
 
 std::string Position::get_fen() const {
@@ -145,8 +154,8 @@ std::string Position::get_fen() const {
 
   // En passant square
   fen += ' ';
-  if (en_passant_square.has_value()) {
-    Square ep_square = en_passant_square.value();
+  if (en_passant_square != NO_SQUARE) {
+    Square ep_square = en_passant_square;
     int file = ep_square % 8;
     int rank = ep_square / 8;
     fen += static_cast<char>('a' + file);
@@ -175,23 +184,111 @@ Piece Position::get_piece_at(Square square) const {
   return Piece{color, type};
 }
 
+/**
+ * @brief Hash the position from scratch, set_fen uses it and debug builds check the incremental key
+ * against it.
+ */
+uint64_t Position::compute_key() const {
+  uint64_t hash = 0;
+
+  for (int index = 0; index < 12; index++) {
+    uint64_t pieces = bitboards[index];
+    while (pieces) {
+      hash ^= ZOBRIST.pieces[index][pop_lsb(pieces)];
+    }
+  }
+
+  hash ^= ZOBRIST.castling[castling_rights];
+  if (en_passant_square != NO_SQUARE) hash ^= ZOBRIST.en_passant[square_file(en_passant_square)];
+  if (to_move == BLACK) hash ^= ZOBRIST.side;
+
+  return hash;
+}
+
+uint64_t Position::compute_pawn_key() const {
+  uint64_t hash = 0;
+
+  for (BitboardIndex index : {WHITE_PAWN, BLACK_PAWN}) {
+    uint64_t pawns = bitboards[index];
+    while (pawns) {
+      hash ^= ZOBRIST.pieces[index][pop_lsb(pawns)];
+    }
+  }
+
+  return hash;
+}
+
+PsqAccumulator Position::compute_psq() const {
+  PsqAccumulator totals;
+
+  for (int index = 0; index < 12; index++) {
+    const int phase_weight = PHASE_WEIGHTS[index % 6 + 1];
+    uint64_t pieces = bitboards[index];
+    while (pieces) {
+      const int square = pop_lsb(pieces);
+      totals.mg += PSQ.mg[index][square];
+      totals.eg += PSQ.eg[index][square];
+      totals.phase += phase_weight;
+    }
+  }
+
+  return totals;
+}
+
+/**
+ * @brief Count earlier occurrences of the current position. Only positions with the same side to
+ * move since the last capture or pawn move can match, so the scan is bounded by the halfmove clock.
+ */
+int Position::count_repetitions() const {
+  int repetitions = 0;
+  const int limit = std::min(halfmove_clock, undo_count);
+
+  for (int ply = 4; ply <= limit; ply += 2) {
+    if (undo_stack[undo_count - ply].key == key) repetitions++;
+  }
+
+  return repetitions;
+}
+
+/**
+ * @brief Dead positions by material alone: lone kings, a single minor piece, or only bishops that
+ * all stand on the same square colour.
+ */
+bool Position::has_insufficient_material() const {
+  const uint64_t heavy_or_pawns = bitboards[WHITE_PAWN] | bitboards[BLACK_PAWN]
+                                  | bitboards[WHITE_ROOK] | bitboards[BLACK_ROOK]
+                                  | bitboards[WHITE_QUEEN] | bitboards[BLACK_QUEEN];
+  if (heavy_or_pawns) return false;
+
+  const uint64_t knights = bitboards[WHITE_KNIGHT] | bitboards[BLACK_KNIGHT];
+  const uint64_t bishops = bitboards[WHITE_BISHOP] | bitboards[BLACK_BISHOP];
+
+  if (count_bits(knights | bishops) <= 1) return true;
+  if (knights) return false;
+
+  return !(bishops & LIGHT_SQUARES) || !(bishops & DARK_SQUARES);
+}
+
 void Position::make_move(const Move &move) {
   uint8_t encoded_piece = lookup_table[move.from];
   Piece piece = decode_piece(encoded_piece);
   Square captured_square = get_captured_square(move);
 
-  uint8_t captured_piece_encoded = 0;
+  uint8_t captured_piece_encoded = move.is_capture() ? lookup_table[captured_square] : 0;
+  push_undo_info(move, captured_piece_encoded);
+
   if (move.is_capture()) {
-    captured_piece_encoded = lookup_table[captured_square];
     Piece captured_piece = decode_piece(captured_piece_encoded);
     remove_piece(captured_piece.color, captured_piece.type, captured_square);
   }
 
-  push_undo_info(move, captured_piece_encoded);
-
   if (castling_rights != 0) update_castling_rights(move, piece, captured_square);
 
-  en_passant_square.reset();
+  if (en_passant_square != NO_SQUARE) {
+    key ^= ZOBRIST.en_passant[square_file(en_passant_square)];
+    en_passant_square = NO_SQUARE;
+  }
+
   if (piece.type == PIECE_PAWN || move.is_capture()) {
     halfmove_clock = 0;
   } else {
@@ -199,12 +296,14 @@ void Position::make_move(const Move &move) {
   }
 
   if (piece.type == PIECE_PAWN) {
-    if (abs(square_rank(move.to) - square_rank(move.from)) == 2) {
+    const bool double_push = abs(square_rank(move.to) - square_rank(move.from)) == 2;
+    if (double_push && can_capture_en_passant(move.to, opposite_color(piece.color))) {
       int to_file = square_file(move.to);
       int from_rank = square_rank(move.from);
       int to_rank = square_rank(move.to);
       int en_passant_rank = (from_rank + to_rank) / 2; // Square between from and to
       en_passant_square = static_cast<Square>(indexes_to_square(en_passant_rank, to_file));
+      key ^= ZOBRIST.en_passant[to_file];
     }
   }
 
@@ -234,13 +333,13 @@ void Position::make_move(const Move &move) {
   }
 
   pass_turn();
+  assert(key == compute_key() && pawn_key == compute_pawn_key() && psq == compute_psq());
 }
 
 void Position::undo_move() {
-  if (undo_stack.empty()) return;
+  if (undo_count == 0) return;
 
-  UndoInfo undo_info = undo_stack.back();
-  undo_stack.pop_back();
+  const UndoInfo &undo_info = undo_stack[--undo_count];
 
   Move move = undo_info.move;
   Square from = move.from;
@@ -282,9 +381,45 @@ void Position::undo_move() {
   castling_rights = undo_info.castling_rights;
   en_passant_square = undo_info.en_passant_square;
   halfmove_clock = undo_info.halfmove_clock;
-  fullmove_counter = undo_info.fullmove_counter;
 
   to_move = opposite_color(to_move);
+  if (to_move == BLACK) fullmove_counter--;
+
+  // Piece updates above already restored the pawn key, the full key also covers rights and side
+  key = undo_info.key;
+  assert(key == compute_key() && pawn_key == compute_pawn_key() && psq == compute_psq());
+}
+
+/**
+ * @brief Pass the turn without moving, for null-move pruning. The halfmove clock restarts so
+ * repetition checks never look back across the null move, where positions are not really
+ * reachable from each other.
+ */
+void Position::make_null_move() {
+  push_undo_info(Move{}, 0);
+
+  if (en_passant_square != NO_SQUARE) {
+    key ^= ZOBRIST.en_passant[square_file(en_passant_square)];
+    en_passant_square = NO_SQUARE;
+  }
+  halfmove_clock = 0;
+
+  pass_turn();
+  assert(key == compute_key());
+}
+
+void Position::undo_null_move() {
+  if (undo_count == 0) return;
+
+  const UndoInfo &undo_info = undo_stack[--undo_count];
+  en_passant_square = undo_info.en_passant_square;
+  halfmove_clock = undo_info.halfmove_clock;
+
+  to_move = opposite_color(to_move);
+  if (to_move == BLACK) fullmove_counter--;
+
+  key = undo_info.key;
+  assert(key == compute_key());
 }
 
 Square Position::get_captured_square(const Move &move) const {
@@ -297,17 +432,29 @@ Square Position::get_captured_square(const Move &move) const {
   return move.to;
 }
 
+/**
+ * @brief Whether a capturer pawn stands beside the pawn that just pushed two squares. Legality is
+ * left to move generation; this only keeps en passant squares nobody can use out of the key.
+ */
+bool Position::can_capture_en_passant(Square pushed_pawn, PieceColor capturer) const {
+  const uint64_t pawn = 1ULL << pushed_pawn;
+  const uint64_t beside = ((pawn << 1) & ~FILE_A) | ((pawn >> 1) & ~FILE_H);
+  return (beside & bitboards[bitboard_index(capturer, PIECE_PAWN)]) != 0;
+}
+
 void Position::push_undo_info(const Move &move, uint8_t captured_piece_encoded) {
-  UndoInfo undo_info;
+  if (undo_count == MAX_POSITION_PLIES) {
+    throw std::length_error("Position::push_undo_info() - Undo stack is full!");
+  }
+
+  UndoInfo &undo_info = undo_stack[undo_count++];
+  undo_info.key = key;
   undo_info.move = move;
   undo_info.captured_piece_encoded = captured_piece_encoded;
 
   undo_info.castling_rights = castling_rights;
   undo_info.en_passant_square = en_passant_square;
-  undo_info.halfmove_clock = halfmove_clock;
-  undo_info.fullmove_counter = fullmove_counter;
-
-  undo_stack.push_back(undo_info);
+  undo_info.halfmove_clock = static_cast<uint16_t>(halfmove_clock);
 }
 
 void Position::update_castling_rights(
@@ -315,16 +462,15 @@ void Position::update_castling_rights(
     const Piece &piece,
     Square captured_square
 ) {
+  const uint8_t previous_rights = castling_rights;
+
   if (piece.type == PIECE_KING) {
     if (piece.color == WHITE) {
       castling_rights &= ~(WHITE_CASTLE_KING | WHITE_CASTLE_QUEEN);
     } else {
       castling_rights &= ~(BLACK_CASTLE_KING | BLACK_CASTLE_QUEEN);
     }
-    return;
-  }
-
-  if (piece.type == PIECE_ROOK) {
+  } else if (piece.type == PIECE_ROOK) {
     if (piece.color == WHITE) {
       if (move.from == H1) {
         castling_rights &= ~WHITE_CASTLE_KING;
@@ -351,6 +497,8 @@ void Position::update_castling_rights(
       castling_rights &= ~BLACK_CASTLE_QUEEN;
     }
   }
+
+  key ^= ZOBRIST.castling[previous_rights] ^ ZOBRIST.castling[castling_rights];
 }
 
 void Position::add_piece(PieceColor color, PieceType piece, Square square) {
@@ -360,6 +508,14 @@ void Position::add_piece(PieceColor color, PieceType piece, Square square) {
   occupancy[ANY] |= square_bit;
 
   lookup_table[square] = encode_piece(color, piece);
+
+  const uint64_t piece_key = ZOBRIST.pieces[bitboard_index(color, piece)][square];
+  key ^= piece_key;
+  if (piece == PIECE_PAWN) pawn_key ^= piece_key;
+
+  psq.mg += PSQ.mg[bitboard_index(color, piece)][square];
+  psq.eg += PSQ.eg[bitboard_index(color, piece)][square];
+  psq.phase += PHASE_WEIGHTS[piece];
 }
 
 void Position::remove_piece(PieceColor color, PieceType piece, Square square) {
@@ -369,6 +525,14 @@ void Position::remove_piece(PieceColor color, PieceType piece, Square square) {
   occupancy[ANY] &= ~square_bit;
 
   lookup_table[square] = 0;
+
+  const uint64_t piece_key = ZOBRIST.pieces[bitboard_index(color, piece)][square];
+  key ^= piece_key;
+  if (piece == PIECE_PAWN) pawn_key ^= piece_key;
+
+  psq.mg -= PSQ.mg[bitboard_index(color, piece)][square];
+  psq.eg -= PSQ.eg[bitboard_index(color, piece)][square];
+  psq.phase -= PHASE_WEIGHTS[piece];
 }
 
 void Position::pass_turn() {
@@ -376,4 +540,47 @@ void Position::pass_turn() {
   if (black_played) fullmove_counter++;
 
   to_move = opposite_color(to_move);
+  key ^= ZOBRIST.side;
+}
+
+bool is_valid_fen(const std::string &fen) {
+  std::istringstream fen_stream(fen);
+  std::string piece_placement, active_color, castling, en_passant, halfmove_str, fullmove_str;
+  fen_stream >> piece_placement >> active_color >> castling >> en_passant >> halfmove_str
+      >> fullmove_str;
+  if (en_passant.empty()) return false;
+
+  int rank = 7, file = 0;
+  int kings[2] = {0, 0};
+  for (char piece_char : piece_placement) {
+    if (piece_char == '/') {
+      if (file != 8 || --rank < 0) return false;
+      file = 0;
+    } else if (piece_char >= '1' && piece_char <= '8') {
+      file += piece_char - '0';
+    } else if (std::string("PNBRQKpnbrqk").find(piece_char) != std::string::npos) {
+      if (piece_char == 'K') kings[WHITE]++;
+      if (piece_char == 'k') kings[BLACK]++;
+      file++;
+    } else {
+      return false;
+    }
+    if (file > 8) return false;
+  }
+  if (rank != 0 || file != 8 || kings[WHITE] != 1 || kings[BLACK] != 1) return false;
+
+  if (active_color != "w" && active_color != "b") return false;
+  if (castling != "-" && castling.find_first_not_of("KQkq") != std::string::npos) return false;
+
+  const char en_passant_rank = active_color == "w" ? '6' : '3';
+  if (en_passant != "-"
+      && (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h'
+          || en_passant[1] != en_passant_rank)) {
+    return false;
+  }
+
+  for (const std::string &counter : {halfmove_str, fullmove_str}) {
+    if (counter.find_first_not_of("0123456789") != std::string::npos) return false;
+  }
+  return true;
 }
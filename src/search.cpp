@@ -0,0 +1,497 @@
+#include "search.hpp"
+
+#include "chess_types.hpp"
+#include "evaluate.hpp"
+#include "move_picker.hpp"
+#include "transposition.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+constexpr int HISTORY_LIMIT = 1 << 20;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_SEARCH_PLY; // Scores beyond this are mates
+
+constexpr int ASPIRATION_WINDOW = 25;   // Initial half-width around the previous score
+constexpr int ASPIRATION_MIN_DEPTH = 4; // Shallower iterations are too unstable to aspire
+constexpr int RFP_MAX_DEPTH = 6;        // Reverse futility pruning
+constexpr int RFP_MARGIN = 80;          // Per ply of remaining depth
+constexpr int FUTILITY_MAX_DEPTH = 3;   // Futility pruning of quiet moves
+constexpr int FUTILITY_MARGIN = 100;    // Per ply of remaining depth
+constexpr int NULL_MOVE_MIN_DEPTH = 3;
+constexpr int NULL_MOVE_REDUCTION = 3;  // Plus one for every six plies of depth
+constexpr int LMR_MIN_MOVES = 3;        // Moves searched at full depth before reducing
+constexpr int LMR_MIN_MOVES_PV = 5;
+
+// Percent of the soft time limit to use by number of iterations the best move has survived: a
+// move that just changed gets extra time, a settled one lets the search stop early
+constexpr int STABILITY_SCALE[] = {150, 110, 90, 75, 60};
+constexpr int MAX_STABILITY = sizeof(STABILITY_SCALE) / sizeof(STABILITY_SCALE[0]) - 1;
+
+/**
+ * @brief Mate scores are stored relative to the node rather than the root, so they stay correct
+ * when the position is reached at a different ply.
+ */
+int score_to_tt(int score, int ply) {
+  if (score >= MATE_SCORE - MAX_SEARCH_PLY) return score + ply;
+  if (score <= -MATE_SCORE + MAX_SEARCH_PLY) return score - ply;
+  return score;
+}
+
+int score_from_tt(int score, int ply) {
+  if (score >= MATE_SCORE - MAX_SEARCH_PLY) return score - ply;
+  if (score <= -MATE_SCORE + MAX_SEARCH_PLY) return score + ply;
+  return score;
+}
+
+int count_non_pawn_pieces(const Position &position, PieceColor color) {
+  const uint64_t pawns_and_king = position.bitboards[bitboard_index(color, PIECE_PAWN)]
+                                  | position.bitboards[bitboard_index(color, PIECE_KING)];
+  return count_bits(position.occupancy[color] & ~pawns_and_king);
+}
+
+} // namespace
+
+Search::Search(const SearchOptions &options) : options(options) {
+  if (!options.nnue_file.empty()) network = std::make_shared<const NnueNetwork>(options.nnue_file);
+}
+
+SearchResult Search::run(const Position &position, const SearchLimits &limits) {
+  this->limits = limits;
+  start_time = std::chrono::steady_clock::now();
+  stop_requested.store(false, std::memory_order_relaxed);
+
+  if (!tt) tt = std::make_unique<TranspositionTable>(options.hash_mb);
+  tt->new_search();
+
+  if (generator.generate_legal_moves(position).empty()) return SearchResult{};
+
+  int threads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+  threads = std::max(1, threads);
+  thread_count = threads;
+  while (static_cast<int>(workers.size()) < threads) {
+    workers.push_back(std::make_unique<Worker>(static_cast<int>(workers.size())));
+  }
+  if (threads > 1 && (!helpers || helpers->size() != threads - 1)) {
+    helpers = std::make_unique<ThreadPool>(threads - 1);
+  }
+
+  for (int i = 0; i < threads; i++) {
+    Worker &worker = *workers[i];
+    worker.position = position;
+    worker.nodes.store(0, std::memory_order_relaxed);
+    worker.tt_probes = 0;
+    worker.tt_hits = 0;
+    worker.pawn_table.probes = 0;
+    worker.pawn_table.hits = 0;
+    worker.stopped = false;
+    worker.previous_pv_length = 0;
+    if (network) network->refresh(worker.position, worker.accumulators[0]);
+
+    // Killers are position specific, history carries over at half weight
+    std::fill(&worker.killers[0][0], &worker.killers[0][0] + 2 * MAX_SEARCH_PLY, Move{});
+    for (auto &color_table : worker.history) {
+      for (auto &from_table : color_table) {
+        for (int &value : from_table) {
+          value /= 2;
+        }
+      }
+    }
+  }
+
+  for (int i = 1; i < threads; i++) {
+    helpers->submit([this, i]() { iterate(*workers[i]); });
+  }
+
+  iterate(*workers[0]);
+
+  // The main thread decides when the search is over, helpers are released as soon as it returns
+  stop_requested.store(true, std::memory_order_relaxed);
+  if (threads > 1) helpers->wait_idle();
+
+  SearchResult result = workers[0]->result;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+  result.seconds = elapsed.count();
+  result.nodes = 0;
+  for (int i = 0; i < threads; i++) {
+    result.nodes += workers[i]->nodes.load(std::memory_order_relaxed);
+    result.tt_probes += workers[i]->tt_probes;
+    result.tt_hits += workers[i]->tt_hits;
+    result.pawn_probes += workers[i]->pawn_table.probes;
+    result.pawn_hits += workers[i]->pawn_table.hits;
+  }
+  result.hashfull = tt->hashfull();
+  return result;
+}
+
+/**
+ * @brief Forget everything learned by earlier searches: the hash tables and move-ordering
+ * history.
+ */
+void Search::clear() {
+  if (tt) tt->clear();
+
+  for (auto &worker : workers) {
+    std::fill(&worker->history[0][0][0], &worker->history[0][0][0] + 2 * 64 * 64, 0);
+    worker->pawn_table.clear();
+  }
+}
+
+/**
+ * @brief Iterative deepening for one thread. Helpers with odd ids start one ply deeper so the
+ * threads spread over different depths and fill the shared table for each other. With a soft time
+ * limit the main thread also decides after each iteration whether another one is worth starting.
+ */
+void Search::iterate(Worker &worker) {
+  SearchResult &result = worker.result;
+  result = SearchResult{};
+  const MoveList root_moves = generator.generate_legal_moves(worker.position);
+  result.best_move = root_moves[0];
+  int stable_iterations = 0;
+
+  const int first_depth = 1 + (worker.id & 1);
+  for (int depth = first_depth; depth <= std::min(limits.depth, MAX_SEARCH_PLY - 1); depth++) {
+    const int score = aspiration_search(worker, depth, result.score);
+
+    // An interrupted iteration is only trusted if nothing better is known
+    if (worker.stopped && result.depth > 0) break;
+
+    if (worker.pv_length[0] > 0) {
+      const Move *pv = worker.pv_table[0];
+      stable_iterations = result.depth > 0 && pv[0] == result.best_move ? stable_iterations + 1 : 0;
+      result.best_move = pv[0];
+      result.pv.assign(pv, pv + worker.pv_length[0]);
+      std::copy(pv, pv + worker.pv_length[0], worker.previous_pv);
+      worker.previous_pv_length = worker.pv_length[0];
+    }
+    result.score = score;
+    result.depth = depth;
+
+    if (worker.stopped || result.is_mate_score()) break;
+
+    // A forced reply needs no thought at all
+    if (worker.id == 0 && limits.soft_time_ms > 0
+        && (root_moves.count == 1 || soft_limit_reached(stable_iterations))) {
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Search the root in a narrow window around the previous iteration's score, widening the
+ * failing side until the score falls inside. A narrow window cuts off far more of the tree.
+ */
+int Search::aspiration_search(Worker &worker, int depth, int previous_score) {
+  int delta = ASPIRATION_WINDOW;
+  int alpha = -INFINITE_SCORE;
+  int beta = INFINITE_SCORE;
+  if (options.features.aspiration && depth >= ASPIRATION_MIN_DEPTH
+      && std::abs(previous_score) < MATE_BOUND) {
+    alpha = std::max(previous_score - delta, -INFINITE_SCORE);
+    beta = std::min(previous_score + delta, INFINITE_SCORE);
+  }
+
+  while (true) {
+    worker.follow_pv = true;
+    const int score = negamax(worker, depth, 0, alpha, beta);
+    if (worker.stopped) return score;
+
+    if (score <= alpha && alpha > -INFINITE_SCORE) {
+      alpha = std::max(score - delta, -INFINITE_SCORE);
+    } else if (score >= beta && beta < INFINITE_SCORE) {
+      beta = std::min(score + delta, INFINITE_SCORE);
+    } else {
+      return score;
+    }
+    delta *= 2;
+  }
+}
+
+int Search::negamax(Worker &worker, int depth, int ply, int alpha, int beta, bool allow_null) {
+  Position &position = worker.position;
+  const SearchFeatures &features = options.features;
+  worker.pv_length[ply] = 0;
+
+  if (should_stop(worker)) return 0;
+  if (ply > 0 && is_draw(position)) return 0;
+
+  const bool in_check = generator.is_in_check(position, position.to_move);
+  if (in_check && features.check_extensions) depth++;
+
+  if (depth <= 0) return quiescence(worker, ply, alpha, beta);
+  if (ply >= MAX_SEARCH_PLY - 1) return static_eval(worker, ply);
+
+  worker.count_node();
+
+  TTEntry entry;
+  worker.tt_probes++;
+  const bool tt_hit = tt->probe(position.key, entry);
+  if (tt_hit) {
+    worker.tt_hits++;
+
+    const int tt_score = score_from_tt(entry.score, ply);
+    if (ply > 0 && entry.depth >= depth) {
+      if (entry.bound == BOUND_EXACT) return tt_score;
+      if (entry.bound == BOUND_LOWER && tt_score >= beta) return tt_score;
+      if (entry.bound == BOUND_UPPER && tt_score <= alpha) return tt_score;
+    }
+  }
+
+  // Pruning decisions below rely on the static evaluation, which means nothing in check or with
+  // a mate score at stake
+  const bool pv_node = beta - alpha > 1;
+  const bool mate_bounds = std::abs(alpha) >= MATE_BOUND || std::abs(beta) >= MATE_BOUND;
+  const bool can_prune = !pv_node && !in_check && !mate_bounds;
+  const int eval = in_check ? -INFINITE_SCORE : static_eval(worker, ply);
+
+  if (features.futility && can_prune && depth <= RFP_MAX_DEPTH
+      && eval - RFP_MARGIN * depth >= beta) {
+    return eval;
+  }
+
+  // If passing the turn still fails high, a real move almost surely does too. Not with a single
+  // piece or only pawns left, where zugzwang is common and passing would be the best move.
+  if (features.null_move && can_prune && allow_null && depth >= NULL_MOVE_MIN_DEPTH
+      && eval >= beta && count_non_pawn_pieces(position, position.to_move) >= 2) {
+    const int reduction = NULL_MOVE_REDUCTION + depth / 6;
+
+    position.make_null_move();
+    if (network) worker.accumulators[ply + 1] = worker.accumulators[ply];
+    const int score = -negamax(worker, depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+    position.undo_null_move();
+    worker.follow_pv = false;
+
+    if (worker.stopped) return 0;
+    if (score >= beta) return score >= MATE_BOUND ? beta : score;
+  }
+
+  // The previous iteration's PV is tried first along the line that leads down it
+  const bool on_pv = worker.follow_pv && ply < worker.previous_pv_length;
+  const uint16_t hash_move =
+      on_pv ? encode_move(worker.previous_pv[ply]) : (tt_hit ? entry.move : 0);
+  worker.follow_pv = on_pv;
+
+  MovePicker &picker = worker.pickers[ply];
+  picker.reset(position, generator, hash_move, worker.killers[ply], &worker.history, false);
+
+  const bool futile = features.futility && can_prune && depth <= FUTILITY_MAX_DEPTH
+                      && eval + FUTILITY_MARGIN * depth <= alpha;
+
+  const int original_alpha = alpha;
+  int best_score = -INFINITE_SCORE;
+  Move best_move{};
+  int move_count = 0;
+  Move move;
+  while (picker.next(move)) {
+    move_count++;
+
+    const bool quiet = !move.is_capture() && !move.is_promotion();
+    make_move(worker, move, ply);
+    tt->prefetch(position.key);
+    const bool gives_check = quiet && (futile || features.late_move_reductions)
+                             && generator.is_in_check(position, position.to_move);
+
+    // Quiet moves cannot lift a hopeless static score by enough this close to the horizon
+    if (futile && quiet && !gives_check && move_count > 1) {
+      position.undo_move();
+      continue;
+    }
+
+    int reduction = 0;
+    if (features.late_move_reductions && quiet && !in_check && !gives_check && depth >= 3
+        && move_count > (pv_node ? LMR_MIN_MOVES_PV : LMR_MIN_MOVES)) {
+      reduction = 1 + (depth >= 6) + (move_count >= 12) - pv_node;
+      reduction = std::clamp(reduction, 0, depth - 2);
+    }
+
+    // Later moves are expected to fail low: prove it with a null window, possibly at reduced
+    // depth, and only search again with the full window when the proof fails
+    int score;
+    if (move_count == 1) {
+      score = -negamax(worker, depth - 1, ply + 1, -beta, -alpha);
+    } else {
+      const int scout_beta = features.pvs ? alpha + 1 : beta;
+      score = -negamax(worker, depth - 1 - reduction, ply + 1, -scout_beta, -alpha);
+      if (score > alpha && reduction > 0) {
+        score = -negamax(worker, depth - 1, ply + 1, -scout_beta, -alpha);
+      }
+      if (score > alpha && score < beta && scout_beta != beta) {
+        score = -negamax(worker, depth - 1, ply + 1, -beta, -alpha);
+      }
+    }
+    position.undo_move();
+    worker.follow_pv = false;
+
+    if (worker.stopped) return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      best_move = move;
+    }
+    if (score > alpha) {
+      alpha = score;
+
+      Move *child_pv = worker.pv_table[ply + 1];
+      worker.pv_table[ply][0] = move;
+      std::copy(child_pv, child_pv + worker.pv_length[ply + 1], worker.pv_table[ply] + 1);
+      worker.pv_length[ply] = worker.pv_length[ply + 1] + 1;
+
+      if (alpha >= beta) {
+        if (quiet) update_quiet_stats(worker, move, depth, ply);
+        break;
+      }
+    }
+  }
+
+  if (move_count == 0) return in_check ? -MATE_SCORE + ply : 0;
+
+  TTEntry new_entry;
+  new_entry.move = encode_move(best_move);
+  new_entry.score = static_cast<int16_t>(score_to_tt(best_score, ply));
+  new_entry.depth = static_cast<uint8_t>(depth);
+  new_entry.bound = best_score >= beta           ? BOUND_LOWER
+                    : best_score > original_alpha ? BOUND_EXACT
+                                                  : BOUND_UPPER;
+  tt->store(position.key, new_entry);
+
+  return best_score;
+}
+
+/**
+ * @brief Resolve captures and promotions until the position is quiet. When in check every evasion
+ * is searched and standing pat is not allowed, so mates at the horizon are still seen.
+ */
+int Search::quiescence(Worker &worker, int ply, int alpha, int beta) {
+  Position &position = worker.position;
+  worker.pv_length[ply] = 0;
+
+  if (should_stop(worker)) return 0;
+
+  worker.count_node();
+
+  if (ply >= MAX_SEARCH_PLY - 1) return static_eval(worker, ply);
+
+  const bool in_check = generator.is_in_check(position, position.to_move);
+
+  int best_score = -INFINITE_SCORE;
+  if (!in_check) {
+    best_score = static_eval(worker, ply);
+    if (best_score >= beta) return best_score;
+    alpha = std::max(alpha, best_score);
+  }
+
+  MovePicker &picker = worker.pickers[ply];
+  picker.reset(position, generator, 0, nullptr, nullptr, !in_check);
+
+  Move move;
+  while (picker.next(move)) {
+    make_move(worker, move, ply);
+    const int score = -quiescence(worker, ply + 1, -beta, -alpha);
+    position.undo_move();
+
+    if (worker.stopped) return 0;
+
+    if (score > best_score) best_score = score;
+    if (score > alpha) {
+      alpha = score;
+      if (alpha >= beta) break;
+    }
+  }
+
+  // Only evasions are searched in check, so no move at all is mate
+  if (in_check && best_score == -INFINITE_SCORE) return -MATE_SCORE + ply;
+
+  return best_score;
+}
+
+/**
+ * @brief Make a move at ply and, with a network loaded, derive the child's accumulator from its
+ * parent's. Undoing needs no work on the accumulators: the parent's entry is left untouched.
+ */
+void Search::make_move(Worker &worker, const Move &move, int ply) const {
+  if (!network) {
+    worker.position.make_move(move);
+    return;
+  }
+
+  const NnueDirty dirty = NnueNetwork::dirty_pieces(worker.position, move);
+  worker.position.make_move(move);
+  network->update(worker.position, dirty, worker.accumulators[ply], worker.accumulators[ply + 1]);
+}
+
+int Search::static_eval(Worker &worker, int ply) const {
+  if (network) return network->evaluate(worker.position, worker.accumulators[ply]);
+  return evaluate(worker.position, &worker.pawn_table);
+}
+
+/**
+ * @brief Remember a quiet move that caused a beta cutoff: as a killer for this ply and in the
+ * history table, weighted by depth since cutoffs near the root save the most work.
+ */
+void Search::update_quiet_stats(Worker &worker, const Move &move, int depth, int ply) {
+  Move *killers = worker.killers[ply];
+  if (killers[0] != move) {
+    killers[1] = killers[0];
+    killers[0] = move;
+  }
+
+  int &entry = worker.history[worker.position.to_move][move.from][move.to];
+  entry += depth * depth;
+
+  // Keep history scores bounded by halving the whole table when one grows large
+  if (entry > HISTORY_LIMIT) {
+    for (auto &from_table : worker.history[worker.position.to_move]) {
+      for (int &value : from_table) {
+        value /= 2;
+      }
+    }
+  }
+}
+
+bool Search::is_draw(const Position &position) const {
+  return position.halfmove_clock >= 100 || position.count_repetitions() >= 1
+         || position.has_insufficient_material();
+}
+
+/**
+ * @brief With one thread the node limit is exact. Otherwise the stop flag, the clock and the
+ * summed node count are polled every 1024 nodes, and only the main thread applies the limits.
+ */
+bool Search::should_stop(Worker &worker) {
+  if (worker.stopped) return true;
+
+  const uint64_t nodes = worker.nodes.load(std::memory_order_relaxed);
+  if (thread_count == 1 && limits.nodes && nodes >= limits.nodes) {
+    worker.stopped = true;
+  } else if ((nodes & 1023) != 0) {
+    return false;
+  } else if (stop_requested.load(std::memory_order_relaxed)) {
+    worker.stopped = true;
+  } else if (worker.id == 0 && limits.stop && limits.stop->load(std::memory_order_relaxed)) {
+    worker.stopped = true;
+  } else if (worker.id == 0 && limits.nodes && total_nodes() >= limits.nodes) {
+    worker.stopped = true;
+  } else if (worker.id == 0 && limits.time_ms > 0) {
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    worker.stopped = elapsed >= std::chrono::milliseconds(limits.time_ms);
+  }
+
+  return worker.stopped;
+}
+
+bool Search::soft_limit_reached(int stable_iterations) const {
+  const int scale = STABILITY_SCALE[std::min(stable_iterations, MAX_STABILITY)];
+  const auto elapsed = std::chrono::steady_clock::now() - start_time;
+  return elapsed >= std::chrono::milliseconds(int64_t{limits.soft_time_ms} * scale / 100);
+}
+
+uint64_t Search::total_nodes() const {
+  uint64_t nodes = 0;
+  for (int i = 0; i < thread_count; i++) {
+    nodes += workers[i]->nodes.load(std::memory_order_relaxed);
+  }
+
+  return nodes;
+}
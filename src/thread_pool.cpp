@@ -0,0 +1,113 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+// The pool the calling thread works for, so a worker of one pool never indexes another's queues
+static thread_local const ThreadPool *worker_pool = nullptr;
+static thread_local int worker_index = -1;
+
+ThreadPool::ThreadPool(int thread_count) {
+  thread_count = std::max(1, thread_count);
+
+  for (int i = 0; i < thread_count; i++) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  for (int i = 0; i < thread_count; i++) {
+    workers.emplace_back([this, i]() { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Queue a task. Tasks submitted from a worker stay on its own deque, outside submissions are
+ * spread round-robin.
+ */
+void ThreadPool::submit(Task task) {
+  int index = current_worker();
+  if (index < 0) index = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks.push_back(std::move(task));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    queued++;
+    pending++;
+  }
+  work_available.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+  std::unique_lock<std::mutex> lock(state_mutex);
+  all_done.wait(lock, [this]() { return pending == 0; });
+}
+
+/**
+ * @brief Index of the calling worker of this pool, -1 when called from any other thread, including
+ * the workers of another pool.
+ */
+int ThreadPool::current_worker() const { return worker_pool == this ? worker_index : -1; }
+
+bool ThreadPool::try_pop(int index, Task &task) {
+  {
+    WorkerQueue &own = *queues[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for (size_t offset = 1; offset < queues.size(); offset++) {
+    WorkerQueue &victim = *queues[(index + offset) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::worker_loop(int index) {
+  worker_pool = this;
+  worker_index = index;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(state_mutex);
+      work_available.wait(lock, [this]() { return stopping || queued > 0; });
+      if (queued == 0) return;
+
+      // Claiming under the lock guarantees a task is sitting in some deque for us
+      queued--;
+    }
+
+    Task task;
+    while (!try_pop(index, task)) {
+      std::this_thread::yield();
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lock(state_mutex);
+    if (--pending == 0) all_done.notify_all();
+  }
+}
@@ -0,0 +1,105 @@
+#include "time_manager.hpp"
+
+#include "chess_types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <string>
+
+namespace {
+
+constexpr int HARD_LIMIT_RATIO = 5;   // Hard limit as a multiple of the soft limit
+constexpr int HARD_LIMIT_DIVISOR = 2; // Never plan to spend more than this share of the clock
+
+} // namespace
+
+/**
+ * @brief The one place a TimeControl is bounded: times within [0, MAX_CLOCK_MS], so clock sums and
+ * engine timeouts stay far from int overflow.
+ */
+void GameClock::reset(const TimeControl &control) {
+  this->control.base_ms = std::clamp(control.base_ms, 0, MAX_CLOCK_MS);
+  this->control.increment_ms = std::clamp(control.increment_ms, 0, MAX_CLOCK_MS);
+  this->control.moves_to_go = std::max(0, control.moves_to_go);
+  for (int color : {WHITE, BLACK}) {
+    remaining[color] = this->control.base_ms;
+    increment[color] = this->control.increment_ms;
+    moves_made[color] = 0;
+  }
+  running = WHITE;
+  restart_turn();
+}
+
+void GameClock::press(PieceColor mover) {
+  if (running == mover) remaining[mover] = remaining_ms(mover);
+  int64_t credit = increment[mover];
+  moves_made[mover]++;
+  if (control.moves_to_go > 0 && moves_made[mover] % control.moves_to_go == 0) {
+    credit += control.base_ms;
+  }
+  remaining[mover] = static_cast<int>(std::min<int64_t>(remaining[mover] + credit, MAX_CLOCK_MS));
+
+  running = opposite_color(mover);
+  restart_turn();
+}
+
+int GameClock::remaining_ms(PieceColor color) const {
+  if (color != running) return remaining[color];
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - turn_start
+  );
+  return std::max<int>(0, remaining[color] - static_cast<int>(elapsed.count()));
+}
+
+int GameClock::moves_to_go(PieceColor color) const {
+  if (control.moves_to_go <= 0) return 0;
+  return control.moves_to_go - moves_made[color] % control.moves_to_go;
+}
+
+/**
+ * @brief Spread the clock evenly over the moves still expected, plus most of the increment since
+ * it comes back after the move. The hard limit leaves room for a few more moves even when one
+ * search overruns its soft limit.
+ */
+TimeBudget allocate_time(int remaining_ms, int increment_ms, int moves_to_go) {
+  const int usable = std::max(0, remaining_ms - MOVE_OVERHEAD_MS);
+  const int horizon = moves_to_go > 0 ? std::min(moves_to_go, DEFAULT_MOVES_TO_GO)
+                                      : DEFAULT_MOVES_TO_GO;
+
+  TimeBudget budget;
+  budget.soft_ms = usable / horizon + increment_ms * 3 / 4;
+  budget.hard_ms =
+      std::max(1, std::min(budget.soft_ms * HARD_LIMIT_RATIO, usable / HARD_LIMIT_DIVISOR));
+  budget.soft_ms = std::clamp(budget.soft_ms, 1, budget.hard_ms);
+  return budget;
+}
+
+TimeBudget allocate_time(const GameClock &clock, PieceColor side) {
+  return allocate_time(clock.remaining_ms(side), clock.increment_ms(side), clock.moves_to_go(side));
+}
+
+bool parse_time_control(const std::string &value, TimeControl &control) {
+  const size_t plus = value.find('+');
+  double minutes = 0.0, seconds = 0.0;
+  try {
+    minutes = std::stod(value.substr(0, plus));
+    if (plus != std::string::npos) seconds = std::stod(value.substr(plus + 1));
+  } catch (const std::exception &) {
+    return false;
+  }
+
+  // Checked in double, before the casts, so out-of-range input cannot reach int
+  const double base_ms = minutes * 60 * 1000;
+  const double increment_ms = seconds * 1000;
+  if (!std::isfinite(base_ms) || !std::isfinite(increment_ms)) return false;
+  if (base_ms < 1 || base_ms > MAX_CLOCK_MS || increment_ms < 0 || increment_ms > MAX_CLOCK_MS) {
+    return false;
+  }
+
+  control.base_ms = static_cast<int>(base_ms);
+  control.increment_ms = static_cast<int>(increment_ms);
+  return true;
+}
@@ -0,0 +1,110 @@
+#include "transposition.hpp"
+
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t size_mb) {
+  size_t bucket_count = 1;
+  const size_t max_buckets = std::max<size_t>(1, (size_mb << 20) / sizeof(Bucket));
+  while (bucket_count * 2 <= max_buckets) {
+    bucket_count *= 2;
+  }
+
+  buckets = std::make_unique<Bucket[]>(bucket_count);
+  bucket_mask = bucket_count - 1;
+}
+
+void TranspositionTable::clear() {
+  for (size_t i = 0; i <= bucket_mask; i++) {
+    for (Entry &entry : buckets[i].entries) {
+      entry.check.store(0, std::memory_order_relaxed);
+      entry.data.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  age = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) const {
+  for (const Entry &slot : bucket_for(key).entries) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+    if (data != 0 && (check ^ data) == key) {
+      entry = unpack(data);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Overwrite the entry for this key if present, otherwise the entry that is least worth
+ * keeping: entries from older searches lose 8 plies of depth per generation of age.
+ */
+void TranspositionTable::store(uint64_t key, const TTEntry &entry) {
+  Bucket &bucket = bucket_for(key);
+  Entry *victim = &bucket.entries[0];
+  int victim_worth = 1 << 30;
+
+  for (Entry &slot : bucket.entries) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+    if (data == 0 || (check ^ data) == key) {
+      // Keep the known move when the new result has none
+      if (data != 0 && entry.move == 0) {
+        TTEntry merged = entry;
+        merged.move = unpack(data).move;
+        const uint64_t merged_data = pack(merged, age);
+        slot.data.store(merged_data, std::memory_order_relaxed);
+        slot.check.store(key ^ merged_data, std::memory_order_relaxed);
+        return;
+      }
+
+      victim = &slot;
+      break;
+    }
+
+    const int entry_age = static_cast<int>(data >> 42) & AGE_MASK;
+    const int age_distance = (age - entry_age) & AGE_MASK;
+    const int worth = static_cast<int>((data >> 32) & 0xFF) - 8 * age_distance;
+    if (worth < victim_worth) {
+      victim = &slot;
+      victim_worth = worth;
+    }
+  }
+
+  const uint64_t data = pack(entry, age);
+  victim->data.store(data, std::memory_order_relaxed);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+  const size_t sample_buckets = std::min<size_t>(250, bucket_mask + 1);
+  int used = 0;
+
+  for (size_t i = 0; i < sample_buckets; i++) {
+    for (const Entry &slot : buckets[i].entries) {
+      const uint64_t data = slot.data.load(std::memory_order_relaxed);
+      if (data != 0 && ((data >> 42) & AGE_MASK) == age) used++;
+    }
+  }
+
+  return static_cast<int>(used * 1000 / (sample_buckets * 4));
+}
+
+uint64_t TranspositionTable::pack(const TTEntry &entry, uint8_t age) {
+  return static_cast<uint64_t>(entry.move) | static_cast<uint64_t>(uint16_t(entry.score)) << 16
+         | static_cast<uint64_t>(entry.depth) << 32 | static_cast<uint64_t>(entry.bound) << 40
+         | static_cast<uint64_t>(age) << 42;
+}
+
+TTEntry TranspositionTable::unpack(uint64_t data) {
+  TTEntry entry;
+  entry.move = static_cast<uint16_t>(data);
+  entry.score = static_cast<int16_t>(data >> 16);
+  entry.depth = static_cast<uint8_t>(data >> 32);
+  entry.bound = static_cast<Bound>((data >> 40) & 0x3);
+  return entry;
+}
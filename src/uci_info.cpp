@@ -0,0 +1,141 @@
+#include "uci_info.hpp"
+
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "notation.hpp"
+#include "position.hpp"
+
+#include <charconv>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief Cut the next space-separated token off the front of rest, empty at the end of the line.
+ */
+std::string_view next_token(std::string_view &rest) {
+  const size_t start = rest.find_first_not_of(" \t\r\n");
+  if (start == std::string_view::npos) {
+    rest = {};
+    return {};
+  }
+
+  const size_t end = rest.find_first_of(" \t\r\n", start);
+  const std::string_view token = rest.substr(start, end - start);
+  rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end);
+  return token;
+}
+
+template<typename T>
+bool parse_number(std::string_view token, T &value) {
+  const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+  return error == std::errc() && end == token.data() + token.size();
+}
+
+/**
+ * @brief Read the number following a keyword and flag the field if it is well formed.
+ */
+template<typename T>
+void parse_field(std::string_view &rest, T &value, UciInfo &info, UciInfoField field) {
+  if (parse_number(next_token(rest), value)) info.fields |= field;
+}
+
+bool looks_like_move(std::string_view token) {
+  return (token.size() == 4 || token.size() == 5) && token[0] >= 'a' && token[0] <= 'h'
+         && token[1] >= '1' && token[1] <= '8';
+}
+
+/**
+ * @brief Play the PV from the root while its moves are legal, then take them all back. Tokens that
+ * are not moves end the PV and are returned unconsumed in rest.
+ */
+void parse_pv(
+    std::string_view &rest,
+    Position &root,
+    const MoveGenerator &generator,
+    UciInfo &info
+) {
+  info.fields |= INFO_PV;
+  info.pv_length = 0;
+
+  int played = 0;
+  while (true) {
+    std::string_view peek = rest;
+    const std::string_view token = next_token(peek);
+    if (!looks_like_move(token)) break;
+    rest = peek;
+
+    if (info.pv_truncated) continue;
+
+    Move move;
+    if (info.pv_length == UCI_INFO_MAX_PV
+        || !uci_to_move(token, generator.generate_legal_moves(root), move)) {
+      info.pv_truncated = true;
+      continue;
+    }
+
+    info.pv[info.pv_length++] = move;
+    root.make_move(move);
+    played++;
+  }
+
+  while (played-- > 0) {
+    root.undo_move();
+  }
+}
+
+} // namespace
+
+bool parse_uci_info(
+    std::string_view line,
+    Position &root,
+    const MoveGenerator &generator,
+    UciInfo &info
+) {
+  std::string_view rest = line;
+  if (next_token(rest) != "info") return false;
+
+  info = UciInfo{};
+  while (true) {
+    const std::string_view key = next_token(rest);
+    if (key.empty() || key == "string") break;
+
+    if (key == "depth") {
+      parse_field(rest, info.depth, info, INFO_DEPTH);
+    } else if (key == "seldepth") {
+      parse_field(rest, info.seldepth, info, INFO_SELDEPTH);
+    } else if (key == "multipv") {
+      parse_field(rest, info.multipv, info, INFO_MULTIPV);
+    } else if (key == "nodes") {
+      parse_field(rest, info.nodes, info, INFO_NODES);
+    } else if (key == "nps") {
+      parse_field(rest, info.nps, info, INFO_NPS);
+    } else if (key == "hashfull") {
+      parse_field(rest, info.hashfull, info, INFO_HASHFULL);
+    } else if (key == "tbhits") {
+      parse_field(rest, info.tbhits, info, INFO_TBHITS);
+    } else if (key == "time") {
+      parse_field(rest, info.time_ms, info, INFO_TIME);
+    } else if (key == "score") {
+      const std::string_view kind = next_token(rest);
+      info.mate = kind == "mate";
+      if ((kind == "cp" || info.mate) && parse_number(next_token(rest), info.score)) {
+        info.fields |= INFO_SCORE;
+      }
+
+      std::string_view peek = rest;
+      const std::string_view bound = next_token(peek);
+      if (bound == "lowerbound" || bound == "upperbound") {
+        info.bound = bound == "lowerbound" ? BOUND_LOWER : BOUND_UPPER;
+        rest = peek;
+      }
+    } else if (key == "pv") {
+      parse_pv(rest, root, generator, info);
+    } else if (key == "currmove" || key == "currmovenumber" || key == "cpuload") {
+      next_token(rest);
+    }
+    // refutation and currline are followed by moves, which fall through as unknown keywords
+  }
+
+  return true;
+}
@@ -0,0 +1,145 @@
+#include "chess_types.hpp"
+#include "evaluate.hpp"
+#include "move_gen.hpp"
+#include "pawn_table.hpp"
+#include "position.hpp"
+#include "search.hpp"
+
+#include <cctype>
+#include <criterion/criterion.h>
+#include <string>
+
+const char *KIWIPETE = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+/**
+ * @brief Same position with colours swapped and the board flipped vertically.
+ */
+std::string mirror_fen(const std::string &fen) {
+  Position position(fen);
+  std::string placement = fen.substr(0, fen.find(' '));
+
+  std::string mirrored;
+  size_t end = placement.size();
+  while (true) {
+    const size_t start = placement.rfind('/', end - 1);
+    const size_t first = start == std::string::npos ? 0 : start + 1;
+    for (size_t i = first; i < end; i++) {
+      const char c = placement[i];
+      mirrored += isupper(c) ? static_cast<char>(tolower(c)) : static_cast<char>(toupper(c));
+    }
+    if (start == std::string::npos) break;
+    mirrored += '/';
+    end = start;
+  }
+
+  mirrored += position.to_move == WHITE ? " b - - 0 1" : " w - - 0 1";
+  return mirrored;
+}
+
+void check_pawn_cache(
+    Position &position,
+    const MoveGenerator &generator,
+    PawnTable &table,
+    int depth
+) {
+  cr_assert_eq(evaluate(position, &table), evaluate(position), "%s", position.get_fen().c_str());
+  if (depth == 0) return;
+
+  for (const Move &move : generator.generate_legal_moves(position)) {
+    position.make_move(move);
+    check_pawn_cache(position, generator, table, depth - 1);
+    position.undo_move();
+  }
+}
+
+void check_accumulators(Position &position, const MoveGenerator &generator, int depth) {
+  if (depth == 0) return;
+
+  const MoveList moves = generator.generate_legal_moves(position);
+  for (const Move &move : moves) {
+    const PsqAccumulator before = position.psq;
+    position.make_move(move);
+    cr_assert(position.psq == position.compute_psq());
+    check_accumulators(position, generator, depth - 1);
+    position.undo_move();
+    cr_assert(position.psq == before);
+  }
+}
+
+Test(evaluate, start_position_is_balanced) {
+  Position position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+  cr_assert_eq(position.psq.phase, MAX_PHASE);
+  cr_assert_eq(position.psq.mg, 0);
+  cr_assert_eq(evaluate(position), 0);
+}
+
+Test(evaluate, accumulators_match_full_recompute) {
+  MoveGenerator generator;
+  for (const char *fen : {KIWIPETE, "8/P1k5/8/8/8/8/5Kp1/8 w - - 0 1"}) {
+    Position position(fen);
+    check_accumulators(position, generator, 3);
+    cr_assert(position.psq == Position(fen).psq);
+  }
+}
+
+Test(evaluate, colour_symmetric) {
+  for (const char *fen :
+       {KIWIPETE, "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 w - - 0 1",
+        "8/5pk1/6p1/8/3R4/6P1/5PK1/8 b - - 0 1"}) {
+    cr_assert_eq(evaluate(Position(fen)), evaluate(Position(mirror_fen(fen))), "%s", fen);
+  }
+}
+
+Test(evaluate, bare_endgame_uses_endgame_weights) {
+  // The e2 pawn shelters a king on e1 but not on b1, which only counts in the middlegame
+  Position sheltered("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+  Position exposed("4k3/8/8/8/8/8/4P3/1K6 w - - 0 1");
+  cr_assert_eq(sheltered.psq.phase, 0);
+  cr_assert_eq(evaluate(sheltered), evaluate(exposed));
+}
+
+Test(evaluate, active_pieces_score_higher) {
+  // Same material, the knight on e5 against one on a8 hemmed in by its own pawns
+  const int active = evaluate(Position("6k1/5ppp/8/4N3/8/8/5PPP/6K1 w - - 0 1"));
+  const int passive = evaluate(Position("N5k1/5ppp/8/8/8/8/5PPP/6K1 w - - 0 1"));
+  cr_assert_gt(active, passive);
+}
+
+Test(evaluate, pawn_cache_matches_uncached) {
+  MoveGenerator generator;
+  PawnTable table(64); // Small, so slots are overwritten and king shelters move often
+  Position position(KIWIPETE);
+  check_pawn_cache(position, generator, table, 3);
+  cr_assert_gt(table.hits, 0);
+}
+
+Test(evaluate, pawn_entry_records_passed_pawns) {
+  // a5 and h6 are passed, e4 is blocked by e5 and d3 is watched by the e-pawn's neighbours
+  Position position("4k3/8/7P/P3p3/4P3/3p4/8/4K3 w - - 0 1");
+  PawnTable table;
+  evaluate(position, &table);
+
+  bool found = false;
+  const PawnEntry &entry = table.probe(position.pawn_key, found);
+  cr_assert(found);
+  cr_assert_eq(entry.passed[WHITE], square_to_bit(A5) | square_to_bit(H6));
+  cr_assert_eq(entry.passed[BLACK], square_to_bit(D3));
+}
+
+Test(evaluate, weak_pawns_are_penalised) {
+  // Same material: a healthy chain against doubled and isolated pawns
+  const int healthy = evaluate(Position("4k3/5ppp/8/8/8/8/5PPP/4K3 w - - 0 1"));
+  const int doubled = evaluate(Position("4k3/5ppp/8/8/8/7P/5P1P/4K3 w - - 0 1"));
+  const int isolated = evaluate(Position("4k3/5ppp/8/8/8/8/P3P2P/4K3 w - - 0 1"));
+  cr_assert_gt(healthy, doubled);
+  cr_assert_gt(healthy, isolated);
+}
+
+Test(evaluate, search_reports_pawn_hits) {
+  Search search;
+  SearchLimits limits;
+  limits.depth = 5;
+  const SearchResult result = search.run(Position(KIWIPETE), limits);
+  cr_assert_gt(result.pawn_probes, 0);
+  cr_assert_gt(result.pawn_hit_rate(), 0.5);
+}
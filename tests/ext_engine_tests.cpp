@@ -0,0 +1,430 @@
+#include "chess_types.hpp"
+#include "ext_engine.hpp"
+#include "game_logic.hpp"
+#include "line_buffer.hpp"
+#include "uci_info.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <criterion/criterion.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Write an executable shell script standing in for a UCI engine.
+ */
+std::string fake_engine(const std::string &name, const std::string &body) {
+  const std::string path = "./" + name;
+  {
+    std::ofstream script(path);
+    script << "#!/bin/sh\n" << body;
+  }
+  chmod(path.c_str(), 0755);
+  return path;
+}
+
+Test(line_buffer, splits_lines_across_reads) {
+  LineBuffer buffer;
+  std::string_view line;
+
+  buffer.append("info de", 7);
+  cr_assert_not(buffer.next_line(line));
+  buffer.append("pth 1\r\nbestmove e2e4\n", 21);
+  cr_assert(buffer.next_line(line));
+  cr_assert(line == "info depth 1");
+  cr_assert(buffer.next_line(line));
+  cr_assert(line == "bestmove e2e4");
+  cr_assert_not(buffer.next_line(line));
+  cr_assert_eq(buffer.size(), 0);
+}
+
+Test(line_buffer, joins_lines_wrapping_around_the_ring) {
+  LineBuffer buffer;
+  std::string_view line;
+
+  const std::string filler(LineBuffer::CAPACITY - 5, 'x');
+  buffer.append(filler.data(), filler.size());
+  buffer.append("\n", 1);
+  cr_assert(buffer.next_line(line));
+  cr_assert_eq(line.size(), filler.size());
+
+  buffer.append("readyok\n", 8);
+  cr_assert(buffer.next_line(line));
+  cr_assert(line == "readyok");
+}
+
+Test(line_buffer, truncates_overlong_lines) {
+  LineBuffer buffer;
+  std::string_view line;
+
+  const std::string filler(LineBuffer::CAPACITY, 'x');
+  cr_assert_eq(buffer.append(filler.data(), filler.size()), LineBuffer::CAPACITY);
+  cr_assert(buffer.next_line(line));
+  cr_assert_eq(line.size(), LineBuffer::CAPACITY);
+
+  buffer.append("xxx\nuciok\n", 10);
+  cr_assert(buffer.next_line(line));
+  cr_assert(line == "uciok");
+}
+
+Test(line_buffer, reads_from_descriptor) {
+  int fds[2];
+  cr_assert_eq(pipe(fds), 0);
+  cr_assert_eq(write(fds[1], "uciok\n", 6), 6);
+  close(fds[1]);
+
+  LineBuffer buffer;
+  std::string_view line;
+  cr_assert_eq(buffer.fill(fds[0]), 6);
+  cr_assert(buffer.next_line(line));
+  cr_assert(line == "uciok");
+  cr_assert_eq(buffer.fill(fds[0]), 0);
+  close(fds[0]);
+}
+
+Test(ext_engine, talks_uci_and_measures_latency) {
+  const std::string path = fake_engine(
+      "ext_engine_tests_fake.sh",
+      "while read cmd rest; do\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo 'id name fake'; echo uciok ;;\n"
+      "    go) echo 'info depth 1 pv e2e4'; echo 'bestmove e2e4 ponder e7e5' ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+
+  {
+    ExtEngine engine(path);
+    int info_lines = 0;
+    engine.set_info_handler([&info_lines](std::string_view line) {
+      cr_assert(line == "info depth 1 pv e2e4");
+      info_lines++;
+    });
+
+    engine.set_position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    cr_assert_eq(engine.get_best_move(1, 100), "e2e4");
+    cr_assert_eq(info_lines, 1);
+    cr_assert_eq(engine.get_best_move(GameClock(), WHITE), "e2e4");
+
+    cr_assert_eq(engine.get_latency("uci").count, 1);
+    cr_assert_eq(engine.get_latency("go").count, 2);
+    cr_assert_geq(engine.get_latency("go").max_ms, engine.get_latency("go").average_ms());
+    cr_assert_eq(engine.get_latency("isready").count, 0);
+  }
+  std::remove(path.c_str());
+}
+
+Test(ext_engine, silent_engine_times_out) {
+  const std::string path = fake_engine("ext_engine_tests_silent.sh", "exec sleep 30\n");
+
+  const auto start = std::chrono::steady_clock::now();
+  bool threw = false;
+  try {
+    ExtEngine engine(path);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  std::remove(path.c_str());
+
+  cr_assert(threw, "Engine without uciok was accepted");
+  cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+Test(ext_engine, forwards_stop_while_thinking) {
+  const std::string path = fake_engine(
+      "ext_engine_tests_infinite.sh",
+      "while read cmd rest; do\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo uciok ;;\n"
+      "    stop) echo 'bestmove e7e5' ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+
+  {
+    ExtEngine engine(path);
+    std::atomic<bool> stop{false};
+    std::thread stopper([&stop]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      stop.store(true);
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::string move = engine.get_best_move(GameClock(), BLACK, &stop);
+    stopper.join();
+
+    cr_assert_eq(move, "e7e5");
+    cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+  }
+  std::remove(path.c_str());
+}
+
+Test(ext_engine, forwards_stop_to_chatty_engine) {
+  const std::string path = fake_engine(
+      "ext_engine_tests_chatty.sh",
+      "while read cmd rest; do\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo uciok ;;\n"
+      "    go) (while :; do echo 'info depth 1 nodes 1'; sleep 0.002; done) & chatter=$! ;;\n"
+      "    stop) kill $chatter; wait $chatter 2>/dev/null; echo 'bestmove e7e5' ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+
+  {
+    ExtEngine engine(path);
+    std::atomic<bool> stop{false};
+    std::thread stopper([&stop]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      stop.store(true);
+    });
+
+    // Lines arrive faster than the signal poll interval, the stop must still get through
+    const auto start = std::chrono::steady_clock::now();
+    const std::string move = engine.get_best_move(GameClock(), BLACK, &stop);
+    stopper.join();
+
+    cr_assert_eq(move, "e7e5");
+    cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+  }
+  std::remove(path.c_str());
+}
+
+Test(ext_engine, game_plays_reply_and_reports_info) {
+  const std::string path = fake_engine(
+      "ext_engine_tests_game.sh",
+      "while read cmd rest; do\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo uciok ;;\n"
+      "    isready) echo readyok ;;\n"
+      "    go) echo 'info depth 3 score cp 20 nodes 300 pv e2e4 e7e5'; echo 'bestmove e2e4' ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+
+  {
+    GameState game(path);
+    cr_assert(game.has_external_engine());
+    game.new_game(PLAYER_VS_ENGINE, BLACK);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (!game.poll_engine_move()) {
+      cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    cr_assert_eq(game.to_move(), BLACK);
+    cr_assert(game.get_engine_info().has_value());
+    const UciInfo &info = *game.get_engine_info();
+    cr_assert_eq(info.depth, 3);
+    cr_assert_eq(info.score, 20);
+    cr_assert_eq(info.pv_length, 2);
+  }
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Engine that logs every command and answers each go with the next move of a fixed list.
+ */
+std::string logging_engine(const std::string &name, const std::string &log, const char *moves) {
+  return fake_engine(
+      name,
+      "set -- " + std::string(moves) + "\n"
+      "while read cmd rest; do\n"
+      "  echo \"$cmd $rest\" >> " + log + "\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo uciok ;;\n"
+      "    isready) echo readyok ;;\n"
+      "    go) echo \"bestmove $1\"; shift ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+}
+
+std::vector<std::string> read_lines(const std::string &path) {
+  std::vector<std::string> lines;
+  std::ifstream file(path);
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+Test(ext_engine, sends_game_history_since_new_game) {
+  const std::string log = "ext_engine_tests_history.log";
+  const std::string path = logging_engine("ext_engine_tests_history.sh", log, "e7e5 b8c6");
+
+  {
+    GameState game(path);
+    game.new_game(PLAYER_VS_ENGINE, WHITE);
+    cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+    cr_assert(game.make_move({G1, F3, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+    cr_assert_eq(game.get_piece_at(C6).type, PIECE_KNIGHT);
+  }
+
+  const std::vector<std::string> lines = read_lines(log);
+  std::remove(path.c_str());
+  std::remove(log.c_str());
+
+  cr_assert_geq(lines.size(), 7);
+  cr_assert_eq(lines[0], "uci ");
+  cr_assert_eq(lines[1], "ucinewgame ");
+  cr_assert_eq(lines[2], "isready ");
+  cr_assert_eq(lines[3], "position startpos moves e2e4");
+  cr_assert_eq(lines[4].rfind("go wtime", 0), 0);
+  cr_assert_eq(lines[5], "position startpos moves e2e4 e7e5 g1f3", "%s", lines[5].c_str());
+  cr_assert_eq(lines[6].rfind("go wtime", 0), 0, "isready sent without need");
+}
+
+Test(ext_engine, sends_custom_root_as_fen) {
+  const std::string fen = "4k3/8/8/8/8/8/4P3/4K3 b - - 0 1";
+  const std::string log = "ext_engine_tests_root.log";
+  const std::string path = logging_engine("ext_engine_tests_root.sh", log, "e8d7 d7c6");
+
+  {
+    GameState game(path, fen);
+    cr_assert(game.make_engine_move());
+    cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+    game.undo_move();
+    cr_assert(game.make_move({E2, E3, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+  }
+
+  const std::vector<std::string> lines = read_lines(log);
+  std::remove(path.c_str());
+  std::remove(log.c_str());
+
+  cr_assert_geq(lines.size(), 6);
+  cr_assert_eq(lines[3], "position fen " + fen);
+  cr_assert_eq(lines[5], "position fen " + fen + " moves e8d7 e2e3", "%s", lines[5].c_str());
+}
+
+/**
+ * @brief Logging engine with the Ponder option. Each answer names the next move of the list and
+ * the one after as the expected reply; "go ponder" waits for ponderhit or stop.
+ */
+std::string pondering_engine(const std::string &name, const std::string &log, const char *moves) {
+  return fake_engine(
+      name,
+      "set -- " + std::string(moves) + "\n"
+      "while read cmd rest; do\n"
+      "  echo \"$cmd $rest\" >> " + log + "\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo 'option name Ponder type check default false'; echo uciok ;;\n"
+      "    isready) echo readyok ;;\n"
+      "    go)\n"
+      "      case \"$rest\" in ponder*) ;; *) echo \"bestmove $1 ponder $2\"; shift 2 ;; esac ;;\n"
+      "    ponderhit|stop) echo \"bestmove $1 ponder $2\"; shift 2 ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+}
+
+Test(ext_engine, ponder_hit_continues_the_search) {
+  const std::string log = "ext_engine_tests_ponderhit.log";
+  const std::string path =
+      pondering_engine("ext_engine_tests_ponderhit.sh", log, "e7e5 g1f3 b8c6 f1b5 a7a6 b5a4");
+
+  {
+    GameState game(path);
+    game.new_game(PLAYER_VS_ENGINE, WHITE);
+    cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+    cr_assert(game.is_engine_pondering());
+
+    cr_assert(game.make_move({G1, F3, NORMAL_MOVE}));
+    cr_assert_not(game.is_engine_pondering());
+    cr_assert(game.is_engine_thinking());
+    cr_assert(game.make_engine_move());
+    cr_assert_eq(game.get_piece_at(C6).type, PIECE_KNIGHT);
+    cr_assert_eq(game.get_ponder_hits(), 1);
+    cr_assert_eq(game.get_ponder_misses(), 0);
+    cr_assert_eq(game.ponder_hit_rate(), 1.0);
+  }
+
+  const std::vector<std::string> lines = read_lines(log);
+  std::remove(path.c_str());
+  std::remove(log.c_str());
+
+  cr_assert_geq(lines.size(), 9);
+  cr_assert_eq(lines[1], "setoption name Ponder value true");
+  cr_assert_eq(lines[2], "ucinewgame ");
+  cr_assert_eq(lines[6], "position startpos moves e2e4 e7e5 g1f3", "%s", lines[6].c_str());
+  cr_assert_eq(lines[7].rfind("go ponder wtime", 0), 0);
+  cr_assert_eq(lines[8], "ponderhit ");
+}
+
+Test(ext_engine, ponder_miss_stops_and_searches_again) {
+  const std::string log = "ext_engine_tests_pondermiss.log";
+  const std::string moves = "e7e5 g1f3 a7a6 f1b5 b8c6 f1c4 g8f6 c4b5";
+  const std::string path = pondering_engine("ext_engine_tests_pondermiss.sh", log, moves.c_str());
+
+  {
+    GameState game(path);
+    game.new_game(PLAYER_VS_ENGINE, WHITE);
+    cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+    cr_assert(game.is_engine_pondering());
+
+    cr_assert(game.make_move({D2, D4, NORMAL_MOVE}));
+    cr_assert_not(game.is_engine_pondering());
+    cr_assert(game.make_engine_move());
+    cr_assert_eq(game.get_piece_at(C6).type, PIECE_KNIGHT);
+    cr_assert_eq(game.get_ponder_hits(), 0);
+    cr_assert_eq(game.get_ponder_misses(), 1);
+  }
+
+  const std::vector<std::string> lines = read_lines(log);
+  std::remove(path.c_str());
+  std::remove(log.c_str());
+
+  cr_assert_geq(lines.size(), 11);
+  cr_assert_eq(lines[7].rfind("go ponder wtime", 0), 0);
+  cr_assert_eq(lines[8], "stop ");
+  cr_assert_eq(lines[9], "position startpos moves e2e4 e7e5 d2d4", "%s", lines[9].c_str());
+  cr_assert_eq(lines[10].rfind("go wtime", 0), 0);
+}
+
+Test(ext_engine, ponder_miss_does_not_wait_on_silent_engine) {
+  const std::string path = fake_engine(
+      "ext_engine_tests_ponderdeaf.sh",
+      "while read cmd rest; do\n"
+      "  case \"$cmd\" in\n"
+      "    uci) echo 'option name Ponder type check default false'; echo uciok ;;\n"
+      "    isready) echo readyok ;;\n"
+      "    go) case \"$rest\" in ponder*) ;; *) echo 'bestmove e7e5 ponder g1f3' ;; esac ;;\n"
+      "    quit) exit 0 ;;\n"
+      "  esac\n"
+      "done\n"
+  );
+
+  {
+    GameState game(path);
+    game.new_game(PLAYER_VS_ENGINE, WHITE);
+    cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+    cr_assert(game.make_engine_move());
+    cr_assert(game.is_engine_pondering());
+
+    // The engine never answers stop; the ponder search's day-long timeout must not apply
+    const auto start = std::chrono::steady_clock::now();
+    cr_assert(game.make_move({D2, D4, NORMAL_MOVE}));
+    cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    cr_assert_eq(game.get_ponder_misses(), 1);
+  }
+  std::remove(path.c_str());
+}
@@ -0,0 +1,107 @@
+#include "chess_types.hpp"
+#include "game_logic.hpp"
+
+#include <criterion/criterion.h>
+#include <string>
+
+void check_result(const std::string &fen, GameResult expected) {
+  GameState board("", fen);
+  GameResult result = board.get_game_result();
+  cr_assert_eq(result, expected, "Result mismatch for %s: got %d", fen.c_str(), result);
+}
+
+Test(game_result, bare_kings) {
+  check_result("8/8/4k3/8/8/3K4/8/8 w - - 0 1", DRAW_INSUFFICIENT_MATERIAL);
+}
+
+Test(game_result, king_and_bishop_vs_king) {
+  check_result("8/8/4k3/8/8/3KB3/8/8 w - - 0 1", DRAW_INSUFFICIENT_MATERIAL);
+}
+
+Test(game_result, king_and_knight_vs_king) {
+  check_result("8/8/4k3/8/8/3KN3/8/8 b - - 0 1", DRAW_INSUFFICIENT_MATERIAL);
+}
+
+Test(game_result, same_colour_bishops) {
+  check_result("8/8/4k1b1/8/8/3K4/4B3/8 w - - 0 1", DRAW_INSUFFICIENT_MATERIAL);
+}
+
+Test(game_result, opposite_colour_bishops_can_mate) {
+  check_result("8/8/4kb2/8/8/3K4/4B3/8 w - - 0 1", GAME_ONGOING);
+}
+
+Test(game_result, two_knights_can_mate) {
+  check_result("8/8/4k3/8/8/3KNN2/8/8 w - - 0 1", GAME_ONGOING);
+}
+
+Test(game_result, single_pawn_can_mate) {
+  check_result("8/8/4k3/8/8/3K4/4P3/8 w - - 0 1", GAME_ONGOING);
+}
+
+Test(game_result, threefold_repetition) {
+  GameState board("");
+  const Move shuffle[] = {{G1, F3}, {G8, F6}, {F3, G1}, {F6, G8}};
+
+  for (int cycle = 0; cycle < 2; cycle++) {
+    cr_assert_eq(board.get_game_result(), GAME_ONGOING, "Repeated only %d times", cycle + 1);
+
+    for (const Move &move : shuffle) {
+      cr_assert(board.make_move(move), "Shuffle move should be legal");
+    }
+  }
+
+  cr_assert_eq(board.get_game_result(), DRAW_REPETITION, "Third occurrence should be a draw");
+
+  board.undo_move();
+  cr_assert_eq(board.get_game_result(), GAME_ONGOING, "Undo should leave the repetition");
+}
+
+Test(game_result, repetition_counts_position_after_double_push) {
+  GameState board("");
+  cr_assert(board.make_move({E2, E4, NORMAL_MOVE}));
+  const Move shuffle[] = {{G8, F6}, {G1, F3}, {F6, G8}, {F3, G1}};
+
+  for (int cycle = 0; cycle < 2; cycle++) {
+    cr_assert_eq(board.get_game_result(), GAME_ONGOING, "Repeated only %d times", cycle + 1);
+
+    for (const Move &move : shuffle) {
+      cr_assert(board.make_move(move), "Shuffle move should be legal");
+    }
+  }
+
+  cr_assert_eq(board.get_game_result(), DRAW_REPETITION, "No pawn could take on e3");
+}
+
+Test(game_result, pawn_move_resets_repetition) {
+  GameState board("");
+  const Move shuffle[] = {{G1, F3}, {G8, F6}, {F3, G1}, {F6, G8}};
+
+  for (const Move &move : shuffle) {
+    board.make_move(move);
+  }
+  board.make_move({E2, E4});
+  board.make_move({E7, E5});
+  for (const Move &move : shuffle) {
+    board.make_move(move);
+  }
+
+  cr_assert_eq(
+      board.get_game_result(),
+      GAME_ONGOING,
+      "Pawn moves make earlier positions unreachable"
+  );
+}
+
+Test(game_result, refuses_moves_past_game_limit) {
+  GameState board("");
+  const Move shuffle[] = {{G1, F3}, {G8, F6}, {F3, G1}, {F6, G8}};
+
+  for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+    cr_assert(board.make_move(shuffle[ply % 4]), "Move %d should be accepted", ply + 1);
+  }
+  cr_assert_not(board.make_move(shuffle[0]), "The undo stack keeps room for searches only");
+  cr_assert_not(board.make_engine_move());
+
+  board.undo_move();
+  cr_assert(board.make_move(shuffle[3]));
+}
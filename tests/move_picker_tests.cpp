@@ -0,0 +1,113 @@
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "move_picker.hpp"
+#include "position.hpp"
+
+#include <algorithm>
+#include <criterion/criterion.h>
+#include <vector>
+
+const char *PICKER_FENS[] = {
+    INITIAL_POSITION_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/8/2k5/3Pp3/8/8/4K2Q b - d3 0 1",
+};
+
+std::vector<Move> pick_all(MovePicker &picker) {
+  std::vector<Move> moves;
+  Move move;
+  while (picker.next(move)) {
+    moves.push_back(move);
+  }
+
+  return moves;
+}
+
+bool same_moves(std::vector<Move> picked, const MoveList &expected) {
+  auto by_code = [](const Move &a, const Move &b) { return encode_move(a) < encode_move(b); };
+  std::vector<Move> sorted(expected.begin(), expected.end());
+  std::sort(picked.begin(), picked.end(), by_code);
+  std::sort(sorted.begin(), sorted.end(), by_code);
+  return picked == sorted;
+}
+
+Test(move_picker, yields_every_legal_move_once) {
+  MoveGenerator generator;
+  MovePicker picker;
+
+  for (const char *fen : PICKER_FENS) {
+    Position position(fen);
+    MoveList legal = generator.generate_legal_moves(position);
+
+    // Hash move and killers taken from the position itself, plus one from elsewhere
+    Move killers[2] = {legal[legal.count - 1], {A1, H8, NORMAL_MOVE}};
+    picker.reset(position, generator, encode_move(legal[legal.count / 2]), killers, nullptr, false);
+
+    std::vector<Move> picked = pick_all(picker);
+    cr_assert(same_moves(picked, legal), "Picked moves differ from legal moves in %s", fen);
+    cr_assert(picked[0] == legal[legal.count / 2], "Hash move not first in %s", fen);
+  }
+}
+
+Test(move_picker, captures_only_yields_non_losing_noisy_moves) {
+  MoveGenerator generator;
+  MovePicker picker;
+
+  for (const char *fen : PICKER_FENS) {
+    Position position(fen);
+    MoveList noisy;
+    for (const Move &move : generator.generate_legal_moves(position)) {
+      if ((move.is_capture() || move.is_promotion()) && generator.see(position, move) >= 0) {
+        noisy.add_move(move);
+      }
+    }
+
+    picker.reset(position, generator, 0, nullptr, nullptr, true);
+    cr_assert(same_moves(pick_all(picker), noisy), "Noisy moves differ in %s", fen);
+  }
+}
+
+Test(move_picker, captures_ordered_by_victim) {
+  MoveGenerator generator;
+  MovePicker picker;
+  Position position("4k3/8/8/3q1r2/4P3/8/8/4K3 w - - 0 1");
+
+  picker.reset(position, generator, 0, nullptr, nullptr, true);
+  Move first;
+  cr_assert(picker.next(first));
+  cr_assert(first == Move({E4, D5, CAPTURE}), "Expected exd5 before exf5");
+}
+
+Test(move_picker, is_legal_matches_generation) {
+  MoveGenerator generator;
+
+  for (const char *fen : PICKER_FENS) {
+    Position position(fen);
+    MoveList legal = generator.generate_legal_moves(position);
+
+    for (const Move &move : generator.generate_pseudo_legal_moves(position)) {
+      const bool expected = std::find(legal.begin(), legal.end(), move) != legal.end();
+      cr_assert_eq(generator.is_legal(position, move), expected, "Mismatch in %s", fen);
+    }
+
+    // Moves of the side not to move, or with wrong flags, are never legal
+    for (const Move &move : legal) {
+      Move wrong_flags = move;
+      wrong_flags.type = static_cast<MoveType>(move.type ^ CAPTURE);
+      cr_assert_not(generator.is_legal(position, wrong_flags), "Accepted bad flags in %s", fen);
+    }
+  }
+}
+
+Test(move_picker, losing_captures_come_last) {
+  MoveGenerator generator;
+  MovePicker picker;
+  Position position("4k3/8/2p5/3p4/8/8/3Q4/4K2R w - - 0 1");
+
+  picker.reset(position, generator, 0, nullptr, nullptr, false);
+  std::vector<Move> picked = pick_all(picker);
+  cr_assert(picked.back() == Move({D2, D5, CAPTURE}), "Expected Qxd5 last");
+}
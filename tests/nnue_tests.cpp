@@ -0,0 +1,154 @@
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "nnue.hpp"
+#include "position.hpp"
+#include "search.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <criterion/criterion.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+constexpr int TEST_HIDDEN = 32;
+
+/**
+ * @brief Serialise a small network with random weights in the on-disk format.
+ */
+std::string random_network(uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> weight(-64, 64);
+
+  std::ostringstream out;
+  auto write_int16 = [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      const int16_t value = static_cast<int16_t>(weight(rng));
+      out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+  };
+
+  const uint32_t inputs = NNUE_INPUTS, hidden = TEST_HIDDEN;
+  const int32_t output_bias = 1234;
+  out.write("CLESSNN1", 8);
+  out.write(reinterpret_cast<const char *>(&inputs), sizeof(inputs));
+  out.write(reinterpret_cast<const char *>(&hidden), sizeof(hidden));
+  write_int16(TEST_HIDDEN);
+  write_int16(static_cast<size_t>(NNUE_INPUTS) * TEST_HIDDEN);
+  write_int16(2 * TEST_HIDDEN);
+  out.write(reinterpret_cast<const char *>(&output_bias), sizeof(output_bias));
+  return out.str();
+}
+
+NnueNetwork load_network(const std::string &bytes) {
+  std::istringstream in(bytes);
+  return NnueNetwork(in);
+}
+
+void check_updates(
+    const NnueNetwork &network,
+    const MoveGenerator &generator,
+    Position &position,
+    const NnueAccumulator &accumulator,
+    int depth
+) {
+  if (depth == 0) return;
+
+  for (const Move &move : generator.generate_legal_moves(position)) {
+    const NnueDirty dirty = NnueNetwork::dirty_pieces(position, move);
+    position.make_move(move);
+
+    NnueAccumulator updated, refreshed;
+    network.update(position, dirty, accumulator, updated);
+    network.refresh(position, refreshed);
+    for (int color : {WHITE, BLACK}) {
+      cr_assert_eq(
+          std::memcmp(updated.values[color], refreshed.values[color], TEST_HIDDEN * 2),
+          0,
+          "%s after %d-%d",
+          position.get_fen().c_str(),
+          move.from,
+          move.to
+      );
+    }
+    cr_assert_eq(network.evaluate(position, updated), network.evaluate(position, refreshed));
+
+    check_updates(network, generator, position, updated, depth - 1);
+    position.undo_move();
+  }
+}
+
+Test(nnue, incremental_updates_match_refresh) {
+  const NnueNetwork network = load_network(random_network(1));
+  MoveGenerator generator;
+
+  // Castling both ways, en passant, promotions with and without capture
+  for (const char *fen :
+       {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1"}) {
+    Position position(fen);
+    NnueAccumulator root;
+    network.refresh(position, root);
+    check_updates(network, generator, position, root, 2);
+  }
+}
+
+Test(nnue, mirrored_positions_evaluate_equally) {
+  const NnueNetwork network = load_network(random_network(2));
+
+  Position white("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+  Position black("rnbqk2r/pppp1ppp/5n2/2b1p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R b KQkq - 4 4");
+  NnueAccumulator white_accumulator, black_accumulator;
+  network.refresh(white, white_accumulator);
+  network.refresh(black, black_accumulator);
+
+  cr_assert_eq(
+      network.evaluate(white, white_accumulator),
+      network.evaluate(black, black_accumulator)
+  );
+}
+
+Test(nnue, rejects_malformed_files) {
+  std::string bytes = random_network(3);
+  cr_assert_eq(load_network(bytes).hidden_size(), TEST_HIDDEN);
+
+  bool threw = false;
+  try {
+    load_network(bytes.substr(0, bytes.size() - 1));
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  cr_assert(threw, "Truncated network was accepted");
+
+  threw = false;
+  bytes[0] = 'X';
+  try {
+    load_network(bytes);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  cr_assert(threw, "Unknown magic was accepted");
+}
+
+Test(nnue, search_uses_network) {
+  const std::string path = "nnue_tests_random.bin";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << random_network(4);
+  }
+
+  Search search({1, 1, path});
+  SearchLimits limits;
+  limits.depth = 4;
+  const SearchResult result =
+      search.run(Position("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"), limits);
+  std::remove(path.c_str());
+
+  // A random network still cannot miss a mate in one, the search proves it
+  cr_assert_eq(result.best_move.from, A1);
+  cr_assert_eq(result.best_move.to, A8);
+  cr_assert(result.is_mate_score());
+}
@@ -1,4 +1,7 @@
 #include "game_logic.hpp"
+#include "move_gen.hpp"
+#include "perft.hpp"
+#include "position.hpp"
 
 #include <criterion/criterion.h>
 #include <vector>
@@ -36,3 +39,85 @@ Test(perft, pos4) {
   GameState board("", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
   test_perft_position(board, {44, 1486, 62379, 2103487, 89941194});
 }
+
+Test(perft, parallel_matches_serial) {
+  const char *kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+  Position position(kiwipete);
+
+  for (int split_depth = 1; split_depth <= 3; split_depth++) {
+    PerftResult result = Perft({.threads = 4, .split_depth = split_depth}).run(position, 4);
+    cr_assert_eq(result.nodes, 4085603, "Split depth %d: got %lu", split_depth, result.nodes);
+  }
+
+  cr_assert_eq(position.get_fen(), kiwipete, "Parallel perft must not touch the root position");
+}
+
+Test(perft, hashed_matches_serial) {
+  Position position("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+
+  PerftResult serial = Perft().run(position, 5);
+  PerftResult hashed = Perft({.hash_mb = 4}).run(position, 5);
+  PerftResult shared = Perft({.threads = 4, .hash_mb = 4}).run(position, 5);
+
+  cr_assert_eq(serial.nodes, 674624, "Serial perft: got %lu", serial.nodes);
+  cr_assert_eq(hashed.nodes, 674624, "Hashed perft: got %lu", hashed.nodes);
+  cr_assert_eq(shared.nodes, 674624, "Parallel hashed perft: got %lu", shared.nodes);
+  cr_assert_gt(hashed.hash_hits, 0, "Transpositions should hit the cache");
+}
+
+Test(perft, hashed_divide_reports_counters) {
+  Position position("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+
+  PerftResult totals;
+  uint64_t nodes = 0;
+  for (const DivideEntry &entry : Perft({.hash_mb = 4}).divide(position, 5, false, &totals)) {
+    nodes += entry.stats.nodes;
+  }
+
+  cr_assert_eq(nodes, 674624, "Hashed divide: got %lu", nodes);
+  cr_assert_gt(totals.hash_probes, 0, "Divide should report cache probes");
+  cr_assert_gt(totals.hash_hits, 0, "Transpositions should hit the cache");
+}
+
+uint64_t compare_bulk_counts(Position &position, const MoveGenerator &generator, int depth) {
+  const MoveList moves = generator.generate_legal_moves(position);
+  const int counted = generator.count_legal_moves(position);
+  cr_assert_eq(counted, moves.count, "Count mismatch at %s", position.get_fen().c_str());
+
+  if (depth == 0) return 1;
+
+  uint64_t checked = 1;
+  for (const Move &move : moves) {
+    position.make_move(move);
+    checked += compare_bulk_counts(position, generator, depth - 1);
+    position.undo_move();
+  }
+
+  return checked;
+}
+
+Test(perft, bulk_count_matches_generation) {
+  MoveGenerator generator;
+  const char *fens[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+  };
+
+  for (const char *fen : fens) {
+    Position position(fen);
+    compare_bulk_counts(position, generator, 3);
+  }
+}
+
+Test(perft, move_type_stats) {
+  Position position("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+  PerftStats stats = Perft().count_stats(position, 4);
+
+  cr_assert_eq(stats.nodes, 43238, "Nodes: got %lu", stats.nodes);
+  cr_assert_eq(stats.captures, 3348, "Captures: got %lu", stats.captures);
+  cr_assert_eq(stats.en_passants, 123, "En passants: got %lu", stats.en_passants);
+  cr_assert_eq(stats.checks, 1680, "Checks: got %lu", stats.checks);
+  cr_assert_eq(stats.discovered_checks, 106, "Discovered checks: got %lu", stats.discovered_checks);
+  cr_assert_eq(stats.checkmates, 17, "Checkmates: got %lu", stats.checkmates);
+}
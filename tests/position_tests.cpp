@@ -0,0 +1,177 @@
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <criterion/criterion.h>
+#include <new>
+
+static bool count_allocations = false;
+static size_t allocation_count = 0;
+
+void *operator new(std::size_t size) {
+  if (count_allocations) allocation_count++;
+
+  void *pointer = std::malloc(size ? size : 1);
+  if (!pointer) throw std::bad_alloc();
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+uint64_t walk_tree(Position &position, const MoveGenerator &generator, int depth) {
+  if (depth == 0) return 1;
+
+  MoveList moves = generator.generate_legal_moves(position);
+  uint64_t nodes = 0;
+  for (const Move &move : moves) {
+    position.make_move(move);
+    nodes += walk_tree(position, generator, depth - 1);
+    position.undo_move();
+  }
+
+  return nodes;
+}
+
+Test(position, no_allocations_in_make_undo_and_generation) {
+  Position position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  MoveGenerator generator;
+
+  allocation_count = 0;
+  count_allocations = true;
+  uint64_t nodes = walk_tree(position, generator, 3);
+  count_allocations = false;
+
+  cr_assert_eq(nodes, 97862, "Unexpected node count %lu", nodes);
+  cr_assert_eq(allocation_count, 0, "Expected no allocations, got %zu", allocation_count);
+}
+
+Test(position, memcpy_snapshot_is_independent) {
+  Position position(INITIAL_POSITION_FEN);
+  position.make_move({E2, E4});
+
+  alignas(Position) unsigned char storage[sizeof(Position)];
+  std::memcpy(storage, &position, sizeof(Position));
+  Position &snapshot = *reinterpret_cast<Position *>(storage);
+
+  position.make_move({E7, E5});
+  position.undo_move();
+  position.undo_move();
+
+  cr_assert_eq(position.get_fen(), INITIAL_POSITION_FEN, "Original should be fully undone");
+  cr_assert_eq(
+      snapshot.get_fen(),
+      "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1",
+      "Snapshot should keep the position it was taken at"
+  );
+
+  snapshot.undo_move();
+  cr_assert_eq(snapshot.get_fen(), INITIAL_POSITION_FEN, "Snapshot should carry its own history");
+}
+
+Test(position, zobrist_key_matches_transpositions) {
+  Position first(INITIAL_POSITION_FEN);
+  Position second(INITIAL_POSITION_FEN);
+  const uint64_t initial_key = first.key;
+
+  for (Move move : {Move{G1, F3}, Move{G8, F6}, Move{B1, C3}, Move{B8, C6}}) {
+    first.make_move(move);
+  }
+  for (Move move : {Move{B1, C3}, Move{B8, C6}, Move{G1, F3}, Move{G8, F6}}) {
+    second.make_move(move);
+  }
+
+  cr_assert_eq(first.key, second.key, "Transposed move orders should hash equally");
+  cr_assert_eq(first.pawn_key, second.pawn_key, "Pawn keys should match as well");
+  cr_assert_neq(first.key, initial_key, "Moving pieces should change the key");
+
+  Position from_fen(first.get_fen());
+  cr_assert_eq(first.key, from_fen.key, "Incremental key should match the key built from FEN");
+
+  for (int i = 0; i < 4; i++) {
+    first.undo_move();
+  }
+  cr_assert_eq(first.key, initial_key, "Undoing every move should restore the key");
+}
+
+Test(position, zobrist_key_tracks_castling_and_en_passant) {
+  Position position("r3k2r/8/8/8/3p4/8/4P3/R3K2R w KQkq - 0 1");
+  const uint64_t pawn_key = position.pawn_key;
+
+  position.make_move({E2, E4});
+  cr_assert_eq(position.key, position.compute_key(), "En passant file should be hashed");
+  cr_assert_neq(position.pawn_key, pawn_key, "Pawn push should change the pawn key");
+
+  position.make_move({D4, E3, EN_PASSANT});
+  position.make_move({E1, G1, CASTLING});
+  position.make_move({A8, A1, CAPTURE});
+  cr_assert_eq(position.key, position.compute_key(), "Castling rights should be hashed");
+  cr_assert_eq(position.pawn_key, position.compute_pawn_key(), "Pawn key should stay in sync");
+
+  for (int i = 0; i < 4; i++) {
+    position.undo_move();
+  }
+  cr_assert_eq(position.key, position.compute_key(), "Undo should restore the key");
+  cr_assert_eq(position.pawn_key, pawn_key, "Undo should restore the pawn key");
+}
+
+Test(position, en_passant_square_only_when_capturable) {
+  Position position(INITIAL_POSITION_FEN);
+  position.make_move({E2, E4});
+  cr_assert_eq(position.en_passant_square, NO_SQUARE, "No black pawn can take on e3");
+
+  position.make_move({D7, D5});
+  position.make_move({E4, E5});
+  const uint64_t key_before_push = position.key;
+  position.make_move({F7, F5});
+  cr_assert_eq(position.en_passant_square, F6, "e5 can take on f6");
+  cr_assert_eq(position.key, position.compute_key());
+  position.undo_move();
+  cr_assert_eq(position.key, key_before_push);
+
+  // Reaching the same placement by single steps or by a useless double push hashes equally
+  Position pushed("4k3/8/8/8/8/8/P7/4K3 w - - 0 1");
+  pushed.make_move({A2, A4});
+  Position stepped("4k3/8/8/8/P7/8/8/4K3 b - - 0 1");
+  cr_assert_eq(pushed.key, stepped.key);
+
+  Position from_fen("4k3/8/8/8/P7/8/8/4K3 b - a3 0 1");
+  cr_assert_eq(from_fen.en_passant_square, NO_SQUARE, "Unusable FEN square is dropped");
+  cr_assert_eq(from_fen.key, stepped.key);
+}
+
+Test(position, validates_fen) {
+  cr_assert(is_valid_fen(INITIAL_POSITION_FEN));
+  cr_assert(is_valid_fen("4k3/8/8/8/8/8/8/4K3 w - -"), "Move counters are optional");
+  cr_assert(is_valid_fen("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"));
+
+  cr_assert_not(is_valid_fen(""));
+  cr_assert_not(is_valid_fen("8/8/8/8/8/8/8/8 w - - 0 1"), "No kings");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/3KK3 w - - 0 1"), "Two white kings");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/4K3 w - - 0 1"), "Seven ranks");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4K3/8 w - - 0 1"), "Nine ranks");
+  cr_assert_not(is_valid_fen("4k4/8/8/8/8/8/8/4K3 w - - 0 1"), "Nine files");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4X3 w - - 0 1"), "Unknown piece");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4K3 x - - 0 1"), "Unknown side to move");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4K3 w KX - 0 1"), "Unknown castling right");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4K3 w - e4 0 1"), "En passant off its rank");
+  cr_assert_not(is_valid_fen("4k3/8/8/8/8/8/8/4K3 w - - x 1"), "Halfmove clock not a number");
+}
+
+Test(position, null_move_round_trip) {
+  Position position("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+  const std::string fen = position.get_fen();
+  const uint64_t key = position.key;
+
+  position.make_null_move();
+  cr_assert_eq(position.to_move, BLACK);
+  cr_assert_eq(position.en_passant_square, NO_SQUARE);
+  cr_assert_eq(position.key, position.compute_key());
+  cr_assert_neq(position.key, key);
+
+  position.undo_null_move();
+  cr_assert_eq(position.get_fen(), fen);
+  cr_assert_eq(position.key, key);
+}
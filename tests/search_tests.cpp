@@ -0,0 +1,297 @@
+#include "chess_types.hpp"
+#include "game_logic.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+#include "search.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <criterion/criterion.h>
+#include <thread>
+
+SearchResult search_fen(const char *fen, const SearchLimits &limits) {
+  static Search search;
+  return search.run(Position(fen), limits);
+}
+
+Test(search, finds_mate_in_one) {
+  SearchLimits limits;
+  limits.depth = 3;
+  SearchResult result = search_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", limits);
+
+  Move expected = {A1, A8, NORMAL_MOVE};
+  cr_assert(result.best_move == expected, "Expected Ra8#");
+  cr_assert_eq(result.score, MATE_SCORE - 1);
+}
+
+Test(search, finds_mate_in_two) {
+  SearchLimits limits;
+  limits.depth = 5;
+  SearchResult result = search_fen("kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", limits);
+
+  Move expected = {A1, A6, NORMAL_MOVE};
+  cr_assert(result.best_move == expected, "Expected Ra6");
+  cr_assert_eq(result.score, MATE_SCORE - 3);
+}
+
+Test(search, wins_hanging_queen) {
+  SearchLimits limits;
+  limits.depth = 4;
+  SearchResult result = search_fen("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1", limits);
+
+  Move expected = {D2, D5, CAPTURE};
+  cr_assert(result.best_move == expected, "Expected Rxd5");
+  cr_assert_gt(result.score, 300);
+}
+
+Test(search, respects_depth_limit) {
+  SearchLimits limits;
+  limits.depth = 3;
+  SearchResult result = search_fen(INITIAL_POSITION_FEN, limits);
+
+  cr_assert_eq(result.depth, 3);
+  cr_assert_geq(result.pv.size(), 3);
+}
+
+Test(search, respects_node_limit) {
+  SearchLimits limits;
+  limits.nodes = 5000;
+  SearchResult result = search_fen(INITIAL_POSITION_FEN, limits);
+
+  cr_assert_leq(result.nodes, 5000);
+  cr_assert(!result.pv.empty());
+}
+
+Test(search, respects_time_limit) {
+  SearchLimits limits;
+  limits.time_ms = 100;
+  SearchResult result = search_fen(INITIAL_POSITION_FEN, limits);
+
+  cr_assert_lt(result.seconds, 0.5);
+  cr_assert(!result.pv.empty());
+}
+
+Test(search, searches_from_full_game_history) {
+  Position position(INITIAL_POSITION_FEN);
+  const Move shuffle[] = {{G1, F3}, {G8, F6}, {F3, G1}, {F6, G8}};
+  for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+    position.make_move(shuffle[ply % 4]);
+  }
+
+  SearchLimits limits;
+  limits.depth = 6;
+  Search search;
+  cr_assert_gt(search.run(position, limits).nodes, 0, "Search plies fit above the game limit");
+}
+
+Test(search, no_moves_when_stalemated) {
+  SearchResult result = search_fen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", SearchLimits{});
+  cr_assert(result.pv.empty());
+}
+
+Test(search, plays_without_external_engine) {
+  GameState game("");
+  game.set_time_control({1000, 0, 0});
+  game.new_game(PLAYER_VS_ENGINE, WHITE);
+  cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+  cr_assert(game.make_engine_move());
+  cr_assert_eq(game.to_move(), WHITE);
+
+  // The engine thinks on its own clock and stays within its budget
+  cr_assert_lt(game.get_clock().remaining_ms(BLACK), 1000);
+  cr_assert_gt(game.get_clock().remaining_ms(BLACK), 500);
+}
+
+Test(search, engine_thinks_in_background) {
+  GameState game("");
+  game.set_time_control({10 * 60 * 1000, 0, 0});
+  game.new_game(PLAYER_VS_ENGINE, WHITE);
+  cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+
+  const auto start = std::chrono::steady_clock::now();
+  cr_assert(game.start_engine_move());
+  cr_assert(game.is_engine_thinking());
+  cr_assert_not(game.make_move({D2, D4, NORMAL_MOVE}), "Moved while the engine was thinking");
+
+  // The budget is seconds, stop makes it reply with what it has
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  game.stop_engine();
+  while (!game.poll_engine_move()) {
+    cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  cr_assert_not(game.is_engine_thinking());
+  cr_assert_eq(game.to_move(), WHITE);
+}
+
+Test(search, stopped_before_first_iteration_still_moves) {
+  std::atomic<bool> stop{true};
+  SearchLimits limits;
+  limits.stop = &stop;
+  const SearchResult result = search_fen(INITIAL_POSITION_FEN, limits);
+
+  const MoveList legal = MoveGenerator().generate_legal_moves(Position(INITIAL_POSITION_FEN));
+  cr_assert(result.pv.empty(), "No iteration should have finished");
+  cr_assert(std::find(legal.begin(), legal.end(), result.best_move) != legal.end());
+
+  GameState game("");
+  game.new_game(PLAYER_VS_ENGINE, WHITE);
+  cr_assert(game.make_move({E2, E4, NORMAL_MOVE}));
+  cr_assert(game.start_engine_move());
+  game.stop_engine();
+
+  const auto start = std::chrono::steady_clock::now();
+  while (!game.poll_engine_move()) {
+    cr_assert(game.is_engine_thinking(), "The engine gave up its turn");
+    cr_assert_lt(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  cr_assert_eq(game.to_move(), WHITE);
+}
+
+Test(search, cancelled_engine_move_is_discarded) {
+  GameState game("");
+  game.set_time_control({10 * 60 * 1000, 0, 0});
+  game.new_game(PLAYER_VS_ENGINE, BLACK);
+  cr_assert(game.is_engine_thinking());
+
+  game.cancel_engine_move();
+  cr_assert_not(game.is_engine_thinking());
+  cr_assert_not(game.poll_engine_move());
+  cr_assert_eq(game.to_move(), WHITE);
+}
+
+Test(search, forced_reply_stops_after_first_iteration) {
+  SearchLimits limits;
+  limits.soft_time_ms = 10000;
+  limits.time_ms = 60000;
+  SearchResult result = search_fen("R6k/6p1/8/8/8/8/8/6K1 b - - 0 1", limits);
+
+  cr_assert_eq(result.depth, 1);
+  cr_assert_lt(result.seconds, 1.0);
+}
+
+Test(search, soft_limit_ends_iterative_deepening) {
+  SearchLimits limits;
+  limits.soft_time_ms = 50;
+  limits.time_ms = 60000;
+  SearchResult result = search_fen(INITIAL_POSITION_FEN, limits);
+
+  cr_assert_gt(result.depth, 1);
+  cr_assert_lt(result.seconds, 5.0);
+}
+
+Test(search, single_thread_is_deterministic) {
+  SearchLimits limits;
+  limits.depth = 5;
+  Search search;
+  Position position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  search.clear();
+  SearchResult first = search.run(position, limits);
+  search.clear();
+  SearchResult second = search.run(position, limits);
+
+  cr_assert_eq(first.nodes, second.nodes);
+  cr_assert_eq(first.score, second.score);
+  cr_assert(first.pv == second.pv);
+}
+
+Test(search, helper_threads_find_same_mate) {
+  SearchOptions options;
+  options.threads = 4;
+  Search search(options);
+
+  SearchLimits limits;
+  limits.depth = 5;
+  SearchResult result = search.run(Position("kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1"), limits);
+
+  Move expected = {A1, A6, NORMAL_MOVE};
+  cr_assert(result.best_move == expected, "Expected Ra6");
+  cr_assert_eq(result.score, MATE_SCORE - 3);
+}
+
+Test(search, stop_from_another_thread) {
+  SearchOptions options;
+  options.threads = 2;
+  Search search(options);
+
+  SearchLimits limits;
+  limits.time_ms = 5000; // Backstop only
+
+  std::thread stopper([&search]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    search.stop();
+  });
+  SearchResult result = search.run(Position(INITIAL_POSITION_FEN), limits);
+  stopper.join();
+
+  cr_assert(!result.pv.empty());
+  cr_assert_lt(result.seconds, 1.0);
+}
+
+Test(search, nested_pools_keep_their_own_worker_indices) {
+  ThreadPool outer(4);
+  ThreadPool inner(1);
+  std::atomic<int> mismatches{0};
+  std::atomic<int> finished{0};
+
+  // The engine thread's pool drives the Lazy SMP pool the same way
+  for (int i = 0; i < 16; i++) {
+    outer.submit([&]() {
+      if (outer.current_worker() < 0 || inner.current_worker() != -1) mismatches++;
+      inner.submit([&]() {
+        if (inner.current_worker() != 0) mismatches++;
+        finished++;
+      });
+    });
+  }
+  outer.wait_idle();
+  inner.wait_idle();
+
+  cr_assert_eq(mismatches.load(), 0);
+  cr_assert_eq(finished.load(), 16);
+}
+
+Test(search, each_feature_can_be_disabled) {
+  SearchLimits limits;
+  limits.depth = 5;
+  const Position position("kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1");
+  Move expected = {A1, A6, NORMAL_MOVE};
+
+  bool SearchFeatures::*toggles[] = {
+      &SearchFeatures::pvs,
+      &SearchFeatures::aspiration,
+      &SearchFeatures::null_move,
+      &SearchFeatures::late_move_reductions,
+      &SearchFeatures::futility,
+      &SearchFeatures::check_extensions,
+  };
+  for (bool SearchFeatures::*toggle : toggles) {
+    SearchOptions options;
+    options.features.*toggle = false;
+    Search search(options);
+    SearchResult result = search.run(position, limits);
+
+    cr_assert(result.best_move == expected, "Expected Ra6");
+    cr_assert_eq(result.score, MATE_SCORE - 3);
+  }
+}
+
+Test(search, selective_search_cuts_nodes) {
+  SearchLimits limits;
+  limits.depth = 6;
+  const Position position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  Search selective;
+  const uint64_t selective_nodes = selective.run(position, limits).nodes;
+
+  Search full_width;
+  full_width.set_features({false, false, false, false, false, false});
+  const uint64_t full_width_nodes = full_width.run(position, limits).nodes;
+
+  cr_assert_lt(selective_nodes * 2, full_width_nodes);
+}
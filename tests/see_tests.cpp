@@ -0,0 +1,55 @@
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+
+#include <criterion/criterion.h>
+
+int see_of(const char *fen, Move move) {
+  MoveGenerator generator;
+  return generator.see(Position(fen), move);
+}
+
+Test(see, undefended_pawn) {
+  cr_assert_eq(see_of("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", {E1, E5, CAPTURE}), 100);
+}
+
+Test(see, knight_takes_defended_pawn) {
+  const char *fen = "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1";
+  cr_assert_eq(see_of(fen, {D3, E5, CAPTURE}), 100 - 320);
+}
+
+Test(see, xray_rook_behind_rook) {
+  // Rxd5 Rxd5 Rxd5 only works because the second rook joins once the first has left
+  cr_assert_eq(see_of("3r2k1/8/8/3p4/8/8/3R4/3R2K1 w - - 0 1", {D2, D5, CAPTURE}), 100);
+}
+
+Test(see, xray_defender_behind_queen) {
+  // Qxd5 Qxd5 Rxd5 Rxd5: the black rook behind the queen has the last word
+  cr_assert_eq(see_of("3r2k1/3q4/8/3p4/8/8/3Q4/3R2K1 w - - 0 1", {D2, D5, CAPTURE}), 100 - 500);
+  cr_assert_eq(see_of("3r2k1/3q4/8/3p4/8/8/8/3Q2K1 w - - 0 1", {D1, D5, CAPTURE}), 100 - 900);
+}
+
+Test(see, king_recaptures_only_undefended_squares) {
+  cr_assert_eq(see_of("8/8/8/4k3/3p4/8/8/3QK3 w - - 0 1", {D1, D4, CAPTURE}), 100 - 900);
+  cr_assert_eq(see_of("8/8/8/4k3/3p4/4P3/8/3QK3 w - - 0 1", {D1, D4, CAPTURE}), 100);
+}
+
+Test(see, en_passant_and_promotion) {
+  cr_assert_eq(see_of("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", {E5, D6, EN_PASSANT}), 100);
+  cr_assert_eq(see_of("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", {B7, B8, PROMOTION, PIECE_QUEEN}), 800);
+  cr_assert_eq(see_of("1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", {A7, A8, PROMOTION, PIECE_QUEEN}), -100);
+}
+
+Test(see, hanging_pieces) {
+  MoveGenerator generator;
+  // exd5 Nxd5 only trades pawns
+  Position defended("4k3/8/1n6/3p4/4P3/8/8/4K3 b - - 0 1");
+  cr_assert_eq(generator.hanging_pieces(defended, BLACK), 0ULL);
+
+  // With Bf3 added, exd5 Nxd5 Bxd5 wins a pawn
+  Position outnumbered("4k3/8/1n6/3p4/4P3/5B2/8/4K3 b - - 0 1");
+  cr_assert_eq(generator.hanging_pieces(outnumbered, BLACK), square_to_bit(D5));
+
+  Position loose("4k3/8/8/3n4/4P3/8/8/4K3 b - - 0 1");
+  cr_assert_eq(generator.hanging_pieces(loose, BLACK), square_to_bit(D5));
+}
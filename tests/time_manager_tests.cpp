@@ -0,0 +1,90 @@
+#include "chess_types.hpp"
+#include "time_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <criterion/criterion.h>
+#include <thread>
+
+Test(time_manager, spreads_clock_over_remaining_moves) {
+  const TimeBudget budget = allocate_time(60000, 0);
+  cr_assert_eq(budget.soft_ms, (60000 - MOVE_OVERHEAD_MS) / DEFAULT_MOVES_TO_GO);
+  cr_assert_gt(budget.hard_ms, budget.soft_ms);
+  cr_assert_leq(budget.hard_ms, 30000);
+}
+
+Test(time_manager, increment_and_moves_to_go_raise_budget) {
+  const TimeBudget base = allocate_time(60000, 0);
+  cr_assert_gt(allocate_time(60000, 2000).soft_ms, base.soft_ms);
+  cr_assert_gt(allocate_time(60000, 0, 5).soft_ms, base.soft_ms);
+}
+
+Test(time_manager, never_plans_to_flag) {
+  for (int remaining : {0, 10, 200, 1000}) {
+    const TimeBudget budget = allocate_time(remaining, 5000, 1);
+    cr_assert_geq(budget.soft_ms, 1);
+    cr_assert_leq(budget.soft_ms, budget.hard_ms);
+    cr_assert_leq(budget.hard_ms, std::max(1, remaining / 2), "%d ms left", remaining);
+  }
+}
+
+Test(time_manager, clock_charges_mover_and_credits_increment) {
+  GameClock clock({1000, 100, 0});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  cr_assert_leq(clock.remaining_ms(WHITE), 950);
+  cr_assert_eq(clock.remaining_ms(BLACK), 1000);
+
+  clock.press(WHITE);
+  const int white = clock.remaining_ms(WHITE);
+  cr_assert(white <= 1050 && white >= 900, "White has %d ms", white);
+  cr_assert_geq(clock.remaining_ms(BLACK), 950);
+}
+
+Test(time_manager, time_control_renews_after_moves_to_go) {
+  GameClock clock({1000, 0, 2});
+  cr_assert_eq(clock.moves_to_go(WHITE), 2);
+
+  clock.press(WHITE);
+  cr_assert_eq(clock.moves_to_go(WHITE), 1);
+  clock.press(BLACK);
+  clock.press(WHITE);
+  cr_assert_eq(clock.moves_to_go(WHITE), 2);
+  cr_assert_gt(clock.remaining_ms(WHITE), 1500);
+}
+
+Test(time_manager, parses_time_control) {
+  TimeControl control;
+  cr_assert(parse_time_control("5+3", control));
+  cr_assert_eq(control.base_ms, 5 * 60 * 1000);
+  cr_assert_eq(control.increment_ms, 3000);
+
+  cr_assert(parse_time_control("0.5", control));
+  cr_assert_eq(control.base_ms, 30000);
+  cr_assert_eq(control.increment_ms, 0);
+}
+
+Test(time_manager, rejects_unusable_time_controls) {
+  for (const char *value : {"", "x", "+3", "0", "-5", "5+-1", "nan", "5+nan", "inf", "1e12",
+                            "40000+0", "5+100000"}) {
+    TimeControl control;
+    cr_assert_not(parse_time_control(value, control), "Accepted \"%s\"", value);
+    cr_assert_eq(control.base_ms, TimeControl{}.base_ms, "Changed by \"%s\"", value);
+    cr_assert_eq(control.increment_ms, TimeControl{}.increment_ms);
+  }
+}
+
+Test(time_manager, clock_stays_within_bounds) {
+  GameClock clock({INT_MAX, INT_MAX - 1000, -3});
+  cr_assert_eq(clock.remaining_ms(BLACK), MAX_CLOCK_MS);
+  cr_assert_eq(clock.increment_ms(WHITE), MAX_CLOCK_MS);
+  cr_assert_eq(clock.moves_to_go(WHITE), 0);
+
+  for (int move = 0; move < 10; move++) {
+    clock.press(WHITE);
+    clock.press(BLACK);
+  }
+  cr_assert_eq(clock.remaining_ms(BLACK), MAX_CLOCK_MS, "Increments must not overflow the clock");
+  cr_assert_leq(clock.remaining_ms(WHITE), MAX_CLOCK_MS);
+  cr_assert_gt(clock.remaining_ms(WHITE), 0);
+}
@@ -0,0 +1,85 @@
+#include "chess_types.hpp"
+#include "transposition.hpp"
+
+#include <criterion/criterion.h>
+
+Test(transposition, store_and_probe) {
+  TranspositionTable table(1);
+  TTEntry entry;
+  entry.move = encode_move({E2, E4, NORMAL_MOVE});
+  entry.score = -123;
+  entry.depth = 7;
+  entry.bound = BOUND_LOWER;
+  table.store(0x1234567890ABCDEFULL, entry);
+
+  TTEntry found;
+  cr_assert(table.probe(0x1234567890ABCDEFULL, found));
+  cr_assert_eq(found.move, entry.move);
+  cr_assert_eq(found.score, -123);
+  cr_assert_eq(found.depth, 7);
+  cr_assert_eq(found.bound, BOUND_LOWER);
+
+  cr_assert_not(table.probe(0x1234567890ABCDEEULL, found));
+}
+
+Test(transposition, keeps_move_when_new_result_has_none) {
+  TranspositionTable table(1);
+  TTEntry entry;
+  entry.move = encode_move({G1, F3, NORMAL_MOVE});
+  entry.depth = 3;
+  entry.bound = BOUND_EXACT;
+  table.store(42, entry);
+
+  entry.move = 0;
+  entry.depth = 5;
+  entry.bound = BOUND_UPPER;
+  table.store(42, entry);
+
+  TTEntry found;
+  cr_assert(table.probe(42, found));
+  cr_assert_eq(found.move, encode_move({G1, F3, NORMAL_MOVE}));
+  cr_assert_eq(found.depth, 5);
+}
+
+Test(transposition, replaces_stale_entries_first) {
+  TranspositionTable table(1);
+  const uint64_t stride = (1ULL << 20) / 64; // Keys one stride apart share a bucket
+
+  // Three deep entries from an old search
+  TTEntry deep;
+  deep.depth = 20;
+  deep.bound = BOUND_EXACT;
+  for (uint64_t i = 0; i < 3; i++) {
+    table.store(1 + i * stride, deep);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    table.new_search();
+  }
+
+  TTEntry shallow;
+  shallow.depth = 2;
+  shallow.bound = BOUND_EXACT;
+  table.store(1 + 3 * stride, shallow);
+  table.store(1 + 4 * stride, shallow);
+
+  TTEntry found;
+  cr_assert(table.probe(1 + 3 * stride, found), "Current entry was evicted before stale ones");
+  cr_assert(table.probe(1 + 4 * stride, found));
+}
+
+Test(transposition, hashfull_counts_current_search) {
+  TranspositionTable table(1);
+  cr_assert_eq(table.hashfull(), 0);
+
+  TTEntry entry;
+  entry.depth = 1;
+  entry.bound = BOUND_EXACT;
+  for (uint64_t key = 0; key < 1000; key++) {
+    table.store(key, entry);
+  }
+  cr_assert_gt(table.hashfull(), 0);
+
+  table.new_search();
+  cr_assert_eq(table.hashfull(), 0);
+}
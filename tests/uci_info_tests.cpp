@@ -0,0 +1,90 @@
+#include "chess_types.hpp"
+#include "move_gen.hpp"
+#include "position.hpp"
+#include "uci_info.hpp"
+
+#include <criterion/criterion.h>
+
+Test(uci_info, parses_every_field) {
+  Position root(INITIAL_POSITION_FEN);
+  MoveGenerator generator;
+  UciInfo info;
+
+  cr_assert(parse_uci_info(
+      "info depth 12 seldepth 18 multipv 1 score cp 35 nodes 1234567 nps 2500000 hashfull 87 "
+      "tbhits 0 time 494 pv e2e4 e7e5 g1f3",
+      root,
+      generator,
+      info
+  ));
+
+  cr_assert_eq(info.depth, 12);
+  cr_assert_eq(info.seldepth, 18);
+  cr_assert_eq(info.multipv, 1);
+  cr_assert_eq(info.score, 35);
+  cr_assert_not(info.mate);
+  cr_assert_eq(info.bound, BOUND_EXACT);
+  cr_assert_eq(info.nodes, 1234567);
+  cr_assert_eq(info.nps, 2500000);
+  cr_assert_eq(info.hashfull, 87);
+  cr_assert(info.has(INFO_TBHITS));
+  cr_assert_eq(info.time_ms, 494);
+
+  cr_assert_eq(info.pv_length, 3);
+  cr_assert_not(info.pv_truncated);
+  cr_assert(info.pv[0] == (Move{E2, E4, NORMAL_MOVE}));
+  cr_assert(info.pv[2] == (Move{G1, F3, NORMAL_MOVE}));
+  cr_assert_eq(root.get_fen(), INITIAL_POSITION_FEN, "PV moves were not taken back");
+}
+
+Test(uci_info, parses_mate_scores_and_bounds) {
+  Position root(INITIAL_POSITION_FEN);
+  MoveGenerator generator;
+  UciInfo info;
+
+  cr_assert(
+      parse_uci_info("info depth 20 score mate -3 upperbound nodes 10", root, generator, info)
+  );
+  cr_assert(info.mate);
+  cr_assert_eq(info.score, -3);
+  cr_assert_eq(info.bound, BOUND_UPPER);
+  cr_assert_eq(info.nodes, 10, "Fields after the bound are lost");
+  cr_assert_not(info.has(INFO_PV));
+}
+
+Test(uci_info, truncates_illegal_pv) {
+  Position root(INITIAL_POSITION_FEN);
+  MoveGenerator generator;
+  UciInfo info;
+
+  cr_assert(parse_uci_info("info pv e2e4 e2e4 d7d5 nodes 5", root, generator, info));
+  cr_assert_eq(info.pv_length, 1);
+  cr_assert(info.pv_truncated);
+  cr_assert_eq(info.nodes, 5);
+  cr_assert_eq(root.get_fen(), INITIAL_POSITION_FEN);
+}
+
+Test(uci_info, handles_promotions_in_pv) {
+  Position root("8/P6k/8/8/8/8/8/K7 w - - 0 1");
+  MoveGenerator generator;
+  UciInfo info;
+
+  cr_assert(parse_uci_info("info depth 1 pv a7a8q h7g6", root, generator, info));
+  cr_assert_eq(info.pv_length, 2);
+  cr_assert_eq(info.pv[0].promotion_piece, PIECE_QUEEN);
+}
+
+Test(uci_info, ignores_strings_and_other_lines) {
+  Position root(INITIAL_POSITION_FEN);
+  MoveGenerator generator;
+  UciInfo info;
+
+  cr_assert_not(parse_uci_info("bestmove e2e4", root, generator, info));
+  cr_assert_not(parse_uci_info("information", root, generator, info));
+
+  cr_assert(parse_uci_info("info string depth 99 pv e2e4", root, generator, info));
+  cr_assert_eq(info.fields, 0);
+
+  cr_assert(parse_uci_info("info currmove e2e4 currmovenumber 1 depth x", root, generator, info));
+  cr_assert_eq(info.fields, 0);
+}
@@ -2,6 +2,7 @@
 #include "game_logic.hpp"
 
 #include <criterion/criterion.h>
+#include <optional>
 #include <string>
 
 struct ExpectedResult {